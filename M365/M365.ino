@@ -19,7 +19,14 @@
 #include "comms.h"
 #include "display_fsm.h"
 #include "range_estimator.h"
+#include "load_graph.h"
 #include "aht10.h"
+#include "idle_mode.h"
+#include "device_info.h"
+#include "ui_cache.h"
+#include "render_task.h"
+#include "frame_sched.h"
+#include "bus_load.h"
 #ifdef SIM_MODE
 #include "sim.h"
 #endif
@@ -56,11 +63,15 @@ void otaService();
  * @return true if display was cleared, false if no action taken
  */
 bool displayClear(byte ID, bool force) {
-  volatile static uint8_t oldID = 0;
-
-  if ((oldID != ID) || force) {
-    display.clear();
-    oldID = ID;
+  // Screen tracking lives with the field cache so a blanked panel also counts as a change.
+  // Between screens with a layout only what the new one will not draw over is cleared,
+  // and fields they share stay on the panel.
+  UiLayout from, to;
+  bool partial = !force && ID != uiScreenCurrent() &&
+                 screenLayout(uiScreenCurrent(), from) && screenLayout(ID, to);
+  if (uiScreenEnter(ID, force, partial ? (from.keep & to.keep) : 0)) {
+    if (partial) uiClearRegions(from, to);
+    else display.clear();
     return true;
   } else return false;
 }
@@ -86,6 +97,10 @@ void WDTint_() {
 // ============================================================================
 
 void setup() {
+#if RENDER_TASK
+  // The bus code takes the state lock from the first frame on, long before the task starts
+  renderInit();
+#endif
   // Initialize serial communication with M365 scooter at 115200 baud
   SERIAL_BEGIN(115200);
 
@@ -100,7 +115,8 @@ void setup() {
   // LOAD SETTINGS FROM EEPROM
   // ============================================================================
   
-  // Prepare EEPROM (ESP32 needs begin/commit). We need extra space for range ring (~64 + 13*10 = 194 bytes). Round up.
+  // Prepare EEPROM (ESP32 needs begin/commit). We need extra space for range ring (~64 + 13*10 = 194 bytes)
+  // and the device info record (200 + 42 = 242 bytes). Round up.
 #if defined(ARDUINO_ARCH_ESP32)
   EEPROM.begin(256);
 #else
@@ -156,6 +172,8 @@ void setup() {
   oledInit(false); // Centralized OLED init (no splash/logo here)
   // Initialize range estimator after EEPROM is ready and before loop
   rangeInit();
+  // Cached ESC/BMS identity; refreshed from the bus once per boot
+  deviceInfoInit();
 
 #if defined(ARDUINO_ARCH_ESP32) && CFG_AHT10_ENABLE
   // Initialize optional AHT10 on I2C (same bus as OLED)
@@ -173,6 +191,7 @@ void setup() {
   display.setCursor(0, 0);
   display.print((char)0x20);              // M365 logo character
   display.setFont(defaultFont);
+  display.flush();
 
 #ifdef SIM_MODE
   // Initialize simulated telemetry values before first frame
@@ -220,6 +239,7 @@ void setup() {
     display.print("Hibernation");
     display.setCursor(0, 1);
     display.print("mode enabled");
+    display.flush();
   // Orderly shutdown: persist learned range if changed
   rangeCheckpointIfNeeded();
   }
@@ -231,6 +251,11 @@ void setup() {
 
   // Ensure splash is fully cleared before the first main frame draws
   display.clear();
+  display.flush();
+  uiCacheInvalidate();
+#if RENDER_TASK
+  renderTaskStart();
+#endif
 }
 
 // Communication and query helpers moved to comms.{h,cpp}
@@ -312,31 +337,68 @@ void otaService() {
 // ============================================================================
 void loop() {
 #ifdef SIM_MODE
-  simTick();
+  #if RENDER_TASK
+    renderLock(); simTick(); renderUnlock();
+  #else
+    simTick();
+  #endif
 #else
   dataFSM();
-  if (_Query.prepared == 0 && !_Hibernate) prepareNextQuery();
+  #if RENDER_TASK
+    dataApplyDeferred();
+  #endif
+  if (_Query.prepared == 0 && !_Hibernate && idlePollDue()) prepareNextQuery();
   if (_NewDataFlag) { _NewDataFlag = 0; Message.Process(); }
 #endif
+  idleTick();
 
-  // Update display according to current state and inputs
-  displayFSM();
-  // Update range learner regularly
+#if RENDER_TASK
+  // Drawing, the OLED and the AHT10 belong to the render task
+  if (renderTryLock()) { rangeTick(); graphTick(); renderUnlock(); }
+#else
+  // Update display according to current state and inputs, at the screen's frame rate.
+  // Drawing and the OLED transfer go in the quiet time before our next TX slot; a
+  // flush cut short there, or by a full TWI queue, continues on the next pass.
+  uint32_t gap = busLoadGapUs();
+  uint32_t budget = (gap == BUS_GAP_UNKNOWN) ? OledDisplay::NO_WAIT : gap;
+  if (oledRecovering()) {
+    // Nothing is drawn while oledService() recovers the I2C bus; the panel is
+    // re-initialized and redrawn in full afterwards
+  } else if (frameDue(gap)) {
+    uint32_t t0 = micros();
+    displayFSM();
+    uint32_t t1 = micros();
+    if (gap != BUS_GAP_UNKNOWN) budget = (gap > t1 - t0) ? gap - (t1 - t0) : 0;
+    display.flush(budget);
+    frameDone(t0, t1);
+  } else {
+    display.flush(budget);
+  }
+  // Update range learner and load graph regularly
   rangeTick();
+  graphTick();
 
 #if defined(ARDUINO_ARCH_ESP32) && CFG_AHT10_ENABLE
   // Opportunistically refresh AHT10 at ~2 Hz without blocking UI too much
   static uint32_t nextAht = 0; uint32_t nowA = millis();
-  if ((int32_t)(nowA - nextAht) >= 0) {
+  if ((int32_t)(nowA - nextAht) >= 0 && !oledRecovering()) {
     nextAht = nowA + 500;
     float t, h; (void)aht10Read(t, h);
   }
 #endif
 
-  // Service OLED (I2C recovery / yield)
+  // OLED health check; advances a bus recovery by one step
   oledService();
+#endif
 
-#if defined(ARDUINO_ARCH_ESP32)
+#if RENDER_TASK
+  // The settings menu starts and stops the OTA server from the render task
+  if (wifiEnabled && renderTryLock()) { otaService(); renderUnlock(); }
+  renderYield();
+#elif defined(ARDUINO_ARCH_ESP32)
   if (wifiEnabled) otaService();
 #endif
+
+  // Parked: sleep until the next tick or bus byte
+  idleSleep();
 }
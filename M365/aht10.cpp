@@ -1,24 +1,39 @@
 #include "aht10.h"
 
 #if defined(ARDUINO_ARCH_ESP32) && CFG_AHT10_ENABLE
+#ifdef DISPLAY_SPI
+// The OLED is not on I2C, so the bus is the sensor's alone
+#include <Wire.h>
+#else
+#include "oled_utils.h"
+#endif
 
 float g_ahtTempC = NAN;
 float g_ahtHum = NAN;
 bool  g_ahtPresent = false;
 
+// The AHT10 is specified up to 400 kHz; the OLED may have the bus clocked faster
+static const uint32_t AHT10_MAX_HZ = 400000L;
+
+static void busSlow() {
+#ifndef DISPLAY_SPI
+  if (i2cClockHz() > AHT10_MAX_HZ) Wire.setClock(AHT10_MAX_HZ);
+#endif
+}
+
+static void busRestore() {
+#ifndef DISPLAY_SPI
+  if (i2cClockHz() > AHT10_MAX_HZ) Wire.setClock(i2cClockHz());
+#endif
+}
+
 static bool aht10WriteCmd(uint8_t c0, uint8_t c1, uint8_t c2) {
   Wire.beginTransmission(AHT10_I2C_ADDRESS);
   Wire.write(c0); Wire.write(c1); Wire.write(c2);
   return Wire.endTransmission() == 0;
 }
 
-bool aht10Init() {
-#ifdef SIM_MODE
-  g_ahtPresent = true; // always present in SIM
-  g_ahtTempC = 22.5f;
-  g_ahtHum = 45.0f;
-  return true;
-#else
+static bool aht10Reset() {
   // Soft reset
   Wire.beginTransmission(AHT10_I2C_ADDRESS);
   Wire.write(0xBA);
@@ -36,22 +51,9 @@ bool aht10Init() {
   delay(10);
   g_ahtPresent = true;
   return true;
-#endif
 }
 
-bool aht10Read(float &tempC, float &rh) {
-  if (!g_ahtPresent) return false;
-#ifdef SIM_MODE
-  // Generate gentle variations over time
-  uint32_t t = millis();
-  float baseT = 22.0f + 3.0f * sinf((float)t / 7000.0f);
-  float baseH = 40.0f + 10.0f * sinf((float)t / 11000.0f + 1.0f);
-  g_ahtTempC = baseT;
-  g_ahtHum = baseH;
-  tempC = g_ahtTempC;
-  rh = g_ahtHum;
-  return true;
-#else
+static bool aht10Measure(float &tempC, float &rh) {
   // Trigger measurement: 0xAC, 0x33, 0x00
   if (!aht10WriteCmd(0xAC, 0x33, 0x00)) {
     g_ahtPresent = false;
@@ -80,6 +82,42 @@ bool aht10Read(float &tempC, float &rh) {
   g_ahtTempC = tempC;
   g_ahtHum = rh;
   return true;
+}
+
+bool aht10Init() {
+#ifdef SIM_MODE
+  g_ahtPresent = true; // always present in SIM
+  g_ahtTempC = 22.5f;
+  g_ahtHum = 45.0f;
+  return true;
+#else
+#ifdef DISPLAY_SPI
+  Wire.begin();
+#endif
+  busSlow();
+  bool ok = aht10Reset();
+  busRestore();
+  return ok;
+#endif
+}
+
+bool aht10Read(float &tempC, float &rh) {
+  if (!g_ahtPresent) return false;
+#ifdef SIM_MODE
+  // Generate gentle variations over time
+  uint32_t t = millis();
+  float baseT = 22.0f + 3.0f * sinf((float)t / 7000.0f);
+  float baseH = 40.0f + 10.0f * sinf((float)t / 11000.0f + 1.0f);
+  g_ahtTempC = baseT;
+  g_ahtHum = baseH;
+  tempC = g_ahtTempC;
+  rh = g_ahtHum;
+  return true;
+#else
+  busSlow();
+  bool ok = aht10Measure(tempC, rh);
+  busRestore();
+  return ok;
 #endif
 }
 
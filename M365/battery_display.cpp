@@ -1,34 +1,82 @@
 #include "battery_display.h"
 #include "range_estimator.h"
+#include "ui_cache.h"
+#include "line_buf.h"
+#include "ride_metrics.h"
+
+// Battery bar on row 7: '[' glyph, 19 segments 5 columns apart, ']' glyph at column 99
+// (over the last segment's fifth column) and its spacing column, then the percentage.
+static const uint8_t BAR_SEGS = 19;
+static const uint8_t BAR_END_COL = 99;
+static const uint8_t BAR_COLS = BAR_END_COL + 6;
+// Range text on row 6: 7 characters up to the right edge
+static const uint8_t RANGE_COL = 86;
+
+// Column k of a defaultFont glyph (fixed width: 6-byte header, 5 columns per glyph)
+static uint8_t glyphCol(uint8_t ch, uint8_t k) {
+  return pgm_read_byte(&defaultFont[6 + (ch - 0x20) * 5 + k]);
+}
+
+// Pixel column c of the bar with fill segments lit
+static uint8_t barCol(uint8_t c, uint8_t fill) {
+  if (c < 5) return glyphCol(0x81, c);
+  if (c >= BAR_END_COL) return (c < BAR_END_COL + 5) ? glyphCol(0x84, c - BAR_END_COL) : 0;
+  uint8_t seg = (c - 5) / 5;
+  return glyphCol(seg < fill ? 0x82 : 0x83, (c - 5) % 5);
+}
+
+// Send bar columns [from, to) as one data run
+static void barWrite(uint8_t from, uint8_t to, uint8_t fill) {
+  display.setCursor(from, 7);
+  for (uint8_t c = from; c < to; c++) display.ssd1306WriteRamBuf(barCol(c, fill));
+}
+
+static uint8_t barFill(uint32_t key) {
+  if (key & (1UL << 9)) return 0;   // regen blink phase
+  uint8_t percent = (uint8_t)key;
+  // Segment i is lit while i < 19% of percent
+  uint8_t fill = (uint8_t)((percent * (uint16_t)BAR_SEGS + 99) / 100);
+  return fill > BAR_SEGS ? BAR_SEGS : fill;
+}
 
 void showBatt(int percent, bool blinkIt) {
+  if (percent < 0) percent = 0;
+  if (percent > 100) percent = 100;
+  bool phase = (millis() % 1000 < 500);
+  bool visible = bigWarn || (warnBatteryPercent == 0) || (percent > warnBatteryPercent) || ((warnBatteryPercent != 0) && phase);
+  bool blank = blinkIt && phase;
+  uint32_t key = (uint32_t)(uint8_t)percent | ((uint32_t)visible << 8) | ((uint32_t)blank << 9);
+  uint32_t old;
+  bool drawn = uiFieldDrawn(UIF_BATT, &old);
+  if (!uiFieldDirty(UIF_BATT, key)) return;
+
   display.set1X();
   display.setFont(defaultFont);
-  display.setCursor(0, 7);
-
-  if (bigWarn || (warnBatteryPercent == 0) || (percent > warnBatteryPercent) || ((warnBatteryPercent != 0) && (millis() % 1000 < 500))) {
-    display.print((char)0x81);
-    for (int i = 0; i < 19; i++) {
-      display.setCursor(5 + i * 5, 7);
-      if (blinkIt && (millis() % 1000 < 500))
-        display.print((char)0x83);
-      else if (float(19) / 100 * percent > i)
-        display.print((char)0x82);
-      else
-        display.print((char)0x83);
+
+  if (!visible) {
+    // Low battery warning blink: blank the whole row in one run
+    display.setCursor(0, 7);
+    display.clearToEOL();
+    return;
+  }
+
+  uint8_t fill = barFill(key);
+  if (drawn && (old & (1UL << 8))) {
+    // Bar already on the panel: resend only the segments that changed
+    uint8_t was = barFill(old);
+    if (was != fill) {
+      uint8_t lo = was < fill ? was : fill, hi = was < fill ? fill : was;
+      uint8_t to = 5 + hi * 5;
+      barWrite(5 + lo * 5, to < BAR_END_COL ? to : BAR_END_COL, fill);
     }
-    display.setCursor(99, 7);
-    display.print((char)0x84);
-    if (percent < 100) display.print(' ');
-    if (percent < 10) display.print(' ');
-    display.print(percent);
-    display.print('%');
+    if ((uint8_t)old == (uint8_t)percent) return;
+    display.setCursor(BAR_COLS, 7);
   } else {
-    for (int i = 0; i < 34; i++) {
-      display.setCursor(i * 5, 7);
-      display.print(' ');
-    }
+    barWrite(0, BAR_COLS, fill);
   }
+  LineBuf line;
+  line.num(percent, FMT_INT3).ch('%');
+  display.print(line.c_str());
 }
 
 void showRangeSmall() {
@@ -39,118 +87,82 @@ void showRangeSmall() {
   if (km > 999.9f) km = 999.9f;
   uint16_t i = (uint16_t)km;
   uint16_t f = (uint16_t)((km - (float)i) * 10.0f + 0.5f);
+  if (f > 9) { i++; f = 0; }
+  if (!uiFieldDirty(UIF_RANGE, (uint32_t)i * 10 + f)) return;
   display.set1X(); display.setFont(defaultFont);
-  // Reserve roughly 8 chars: "123.4km"
-  const uint8_t colStart = 86; // near right edge but before battery %
-  display.setCursor(colStart, 6);
-  // Clear area
-  for (uint8_t c = 0; c < 12; ++c) display.print(' ');
-  display.setCursor(colStart, 6);
-  if (i < 100) display.print(' ');
-  if (i < 10) display.print(' ');
-  display.print(i);
-  display.print('.'); display.print(f);
-  display.print((const __FlashStringHelper *) l_km);
+  // Fixed width, 7 chars: "123.4km"; padding overwrites the previous value
+  display.setCursor(RANGE_COL, 6);
+  LineBuf line;
+  line.num((int32_t)i * 10 + f, FMT_FIX3_1).pstr(l_km);
+  display.print(line.c_str());
 }
 
-void fsBattInfo() {
-  displayClear(6);
-  int16_t tmp_0, tmp_1;
-  display.setCursor(0, 0);
-  display.set1X();
+void bottomLayout(UiLayout& l) {
+  // Row 7 is always written in full: bar and "100%" reach past the edge, and the
+  // warning blink blanks the whole row. The bar looks the same on every screen.
+  l.uses(0, 127, 7, 7).paints(0, 127, 7, 7);
+  l.keep |= 1UL << UIF_BATT;
+  l.uses(RANGE_COL, 127, 6, 6).paints(RANGE_COL, 127, 6, 6);
+}
 
-  tmp_0 = abs(S25C31.voltage) / 100;
-  tmp_1 = abs(S25C31.voltage) % 100;
-  if (tmp_0 < 10) display.print(' ');
-  display.print(tmp_0);
-  display.print('.');
-  if (tmp_1 < 10) display.print('0');
-  display.print(tmp_1);
-  display.print((const __FlashStringHelper *) l_v);
-  display.print(' ');
+// Battery info row 0: voltage, current or power, remaining capacity
+static void battInfoSummary() {
+  const RIDE_METRICS_t& m = rideMetrics();
+  int16_t cur_cA = m.current_cA;
+  const int16_t key[4] = { S25C31.voltage, cur_cA, (int16_t)S25C31.remainCapacity, (int16_t)showPower };
+  if (!uiFieldDirtyBuf(UIF_BI_SUMMARY, key, sizeof(key))) return;
+
+  LineBuf line;
+  line.num(abs(S25C31.voltage), FMT_FIX2_2).pstr(l_v).ch(' ');
 
   if (!showPower) {
-    int16_t cur_cA = totalCurrent_cA();
-    tmp_0 = abs(cur_cA) / 100;
-    tmp_1 = abs(cur_cA) % 100;
-    if (tmp_0 < 10) display.print(' ');
-    display.print(tmp_0);
-    display.print('.');
-    if (tmp_1 < 10) display.print('0');
-    display.print(tmp_1);
-    display.print((const __FlashStringHelper *) l_a);
+    line.num(abs(cur_cA), FMT_FIX2_2).pstr(l_a);
   } else {
-  uint32_t ai = (uint32_t)abs(totalCurrent_cA());
-    uint32_t vi = (uint32_t)abs(S25C31.voltage);
-    uint32_t m = (ai * vi + 50) / 100; // centi-watts
-    tmp_0 = (int16_t)(m / 100);
-    tmp_1 = (int16_t)(m % 100);
-    if (tmp_0 < 10) display.print(' ');
-    display.print(tmp_0);
-    display.print('.');
-    if (tmp_1 < 10) display.print('0');
-    display.print(tmp_1);
-    display.print((const __FlashStringHelper *) l_w);
+    line.num((int32_t)m.pwh * 100 + m.pwl, FMT_FIX2_2).pstr(l_w);
   }
-  display.print(' ');
+  line.ch(' ');
+
+  line.num(S25C31.remainCapacity, FMT_INT4).pstr(l_mah);
+  display.setCursor(0, 0);
+  display.print(line.c_str());
+}
 
-  if (S25C31.remainCapacity < 1000) display.print(' ');
-  if (S25C31.remainCapacity < 100) display.print(' ');
-  if (S25C31.remainCapacity < 10) display.print(' ');
-  display.print(S25C31.remainCapacity);
-  display.print((const __FlashStringHelper *) l_mah);
+// Battery info row 1: pack temperatures
+static void battInfoTemps() {
+  if (!uiFieldDirty(UIF_BI_TEMPS, ((uint32_t)S25C31.temp1 << 8) | S25C31.temp2)) return;
 
-  int temp;
-  temp = S25C31.temp1 - 20;
+  LineBuf line;
+  line.pstr(l_t).str("1: ").num(S25C31.temp1 - 20, FMT_INT2).ch((char)0x80).ch('C');
   display.setCursor(9, 1);
-  display.print((const __FlashStringHelper *) l_t);
-  display.print("1: ");
-  if (temp < 10) display.print(' ');
-  display.print(temp);
-  display.print((char)0x80);
-  display.print("C");
+  display.print(line.c_str());
 
+  line.clear().pstr(l_t).str("2: ").num(S25C31.temp2 - 20, FMT_INT2).ch((char)0x80).ch('C');
   display.setCursor(74, 1);
-  display.print((const __FlashStringHelper *) l_t);
-  display.print("2: ");
-  temp = S25C31.temp2 - 20;
-  if (temp < 10) display.print(' ');
-  display.print(temp);
-  display.print((char)0x80);
-  display.print("C");
-
-  int16_t v;
+  display.print(line.c_str());
+}
+
+void fsBattInfo() {
+  displayClear(6);
+  display.set1X();
+
+  battInfoSummary();
+  battInfoTemps();
+
   int16_t * ptr;
   int16_t * ptr2;
   ptr = (int16_t*)&S25C40;
   ptr2 = ptr + 5;
 
-  for (uint8_t i = 0; i < 5; i++) {
+  // Cell rows: cells i and i+5 side by side, redrawn only when either changes
+  for (uint8_t i = 0; i < 5; i++, ptr++, ptr2++) {
+    if (!uiFieldDirty(UIF_BI_CELLS + i, ((uint32_t)(uint16_t)*ptr << 16) | (uint16_t)*ptr2)) continue;
+    LineBuf line;
+    line.ch((char)('0' + i)).str(": ").num(*ptr, FMT_FIX1_3).pstr(l_v);
     display.setCursor(5, 2 + i);
-    display.print(i);
-    display.print(": ");
-    v = *ptr / 1000;
-    display.print(v);
-    display.print('.');
-    v = *ptr % 1000;
-    if (v < 100) display.print('0');
-    if (v < 10) display.print('0');
-    display.print(v);
-    display.print((const __FlashStringHelper *) l_v);
+    display.print(line.c_str());
 
+    line.clear().ch((char)('5' + i)).str(": ").num(*ptr2, FMT_FIX1_3).pstr(l_v);
     display.setCursor(70, 2 + i);
-    display.print(i + 5);
-    display.print(": ");
-    v = *ptr2 / 1000;
-    display.print(v);
-    display.print('.');
-    v = *ptr2 % 1000;
-    if (v < 100) display.print('0');
-    if (v < 10) display.print('0');
-    display.print(v);
-    display.print((const __FlashStringHelper *) l_v);
-
-    ptr++;
-    ptr2++;
+    display.print(line.c_str());
   }
 }
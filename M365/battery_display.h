@@ -9,3 +9,7 @@ void fsBattInfo();
 
 // Draw small range estimate text on the right side of the battery bar
 void showRangeSmall();
+
+// Add the bottom rows as showBatt() and showRangeSmall() draw them to a screen layout
+struct UiLayout;
+void bottomLayout(UiLayout& l);
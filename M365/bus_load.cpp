@@ -0,0 +1,103 @@
+#include "bus_load.h"
+
+// 8N1 at 115200 baud moves 11520 bytes per second
+static const uint16_t LINE_BYTES_PER_S = 11520;
+static const uint16_t WINDOW_MS        = 1000;
+static const uint16_t BACKOFF_STEP_MS  = 20;
+static const uint16_t OWN_BUDGET_BYTES = (uint32_t)LINE_BYTES_PER_S * CFG_BUS_OWN_BUDGET_PCT / 100;
+
+// Counters for the current window
+static uint32_t s_winStart = 0;
+static uint16_t s_rxBytes = 0, s_txBytes = 0;
+static uint8_t  s_csErrors = 0, s_foreign = 0;
+
+static uint8_t  s_utilPct = 0;
+static uint16_t s_backoffMs = 0;
+static uint32_t s_lastTxMs = 0;
+static uint8_t  s_lastQueryCmd = 0xFF;
+
+// Control frame cadence
+static uint32_t s_ctlUs = 0;         // micros() of the last control frame
+static uint32_t s_ctlPeriodUs = 0;   // smoothed period, 0 = not learned yet
+
+// Close the window once a second: publish utilisation and adapt the backoff.
+// Congestion doubles the interval between our polls, a calm window shrinks it by a step.
+static void busLoadRoll() {
+  uint32_t now = millis();
+  uint32_t elapsed = now - s_winStart;
+  if (elapsed < WINDOW_MS) return;
+  s_winStart = now;
+
+  uint32_t lineBytes = (uint32_t)LINE_BYTES_PER_S * elapsed / 1000UL;
+  uint32_t pct = ((uint32_t)s_rxBytes + s_txBytes) * 100UL / lineBytes;
+  s_utilPct = (pct > 100) ? 100 : (uint8_t)pct;
+
+  bool congested = (s_utilPct >= CFG_BUS_BUSY_PCT) || (s_csErrors >= CFG_BUS_ERR_PER_S) || (s_foreign >= CFG_BUS_FOREIGN_PER_S);
+  if (congested) {
+    uint16_t next = s_backoffMs ? (uint16_t)(s_backoffMs * 2) : BACKOFF_STEP_MS;
+    s_backoffMs = (next > CFG_BUS_BACKOFF_MAX_MS) ? CFG_BUS_BACKOFF_MAX_MS : next;
+  } else {
+    s_backoffMs = (s_backoffMs > BACKOFF_STEP_MS) ? (s_backoffMs - BACKOFF_STEP_MS) : 0;
+  }
+
+  s_rxBytes = 0; s_txBytes = 0; s_csErrors = 0; s_foreign = 0;
+}
+
+void busLoadOnRx(uint8_t bytes) {
+  busLoadRoll();
+  if (s_rxBytes < 0xFFFF - bytes) s_rxBytes += bytes;
+}
+
+void busLoadOnChecksumError() {
+  if (s_csErrors < 0xFF) s_csErrors++;
+}
+
+static void busCadenceOnControl() {
+  uint32_t now = micros();
+  uint32_t dt = now - s_ctlUs;
+  s_ctlUs = now;
+  // Ignore gaps (missed frames, hibernation) and frames we parsed late
+  if (s_ctlPeriodUs == 0) { if (dt < 200000UL) s_ctlPeriodUs = dt; return; }
+  if (dt < s_ctlPeriodUs / 2 || dt > s_ctlPeriodUs + s_ctlPeriodUs / 2) return;
+  s_ctlPeriodUs = (s_ctlPeriodUs * 7 + dt) / 8;
+}
+
+void busLoadOnFrame(uint8_t addr, uint8_t hz, uint8_t cmd) {
+  if (addr == 0x20 && cmd == 0x00 && hz == 0x65) busCadenceOnControl();
+  // BLE <-> ESC control frames (cmd 0x00) are the scooter's own cyclic traffic
+  if ((addr == 0x20 || addr == 0x21) && cmd == 0x00) return;
+  // Answers to our last query, or the echo of our own request
+  if (cmd == s_lastQueryCmd && (addr == 0x23 || addr == 0x25 || (millis() - s_lastTxMs) < 5)) return;
+  (void)hz;
+  if (s_foreign < 0xFF) s_foreign++;
+}
+
+void busLoadOnTx(const uint8_t* frame, uint8_t len) {
+  busLoadRoll();
+  s_txBytes += len;
+  s_lastTxMs = millis();
+  // 55 AA len addr hz cmd ...
+  if (len > 5) s_lastQueryCmd = frame[5];
+}
+
+bool busLoadMayTransmit(uint8_t len) {
+  busLoadRoll();
+  if (s_backoffMs && (millis() - s_lastTxMs) < s_backoffMs) return false;
+  return ((uint32_t)s_txBytes + len) <= OWN_BUDGET_BYTES;
+}
+
+uint8_t busLoadUtilPct() { busLoadRoll(); return s_utilPct; }
+
+uint16_t busLoadBackoffMs() { busLoadRoll(); return s_backoffMs; }
+
+uint32_t busLoadGapUs() {
+  uint32_t period = s_ctlPeriodUs;
+  if (period == 0) return BUS_GAP_UNKNOWN;
+  uint32_t since = micros() - s_ctlUs;
+  // A silent bus has no slot to protect
+  if (since > period * 4) return BUS_GAP_UNKNOWN;
+  since %= period;
+  if (since < CFG_BUS_SLOT_HOLD_US) return 0;
+  uint32_t toNext = period - since;
+  return (toNext > CFG_BUS_SLOT_GUARD_US) ? toNext - CFG_BUS_SLOT_GUARD_US : 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "defines.h"
+
+// Bus utilisation estimate and polling budget. We share the line with the stock BLE
+// module and often a phone app; our own polls back off when the bus gets crowded.
+
+// Hooks from the RX/TX paths
+void busLoadOnRx(uint8_t bytes);
+void busLoadOnChecksumError();
+void busLoadOnFrame(uint8_t addr, uint8_t hz, uint8_t cmd);
+void busLoadOnTx(const uint8_t* frame, uint8_t len);
+
+// True if a frame of len bytes fits the budget and the current backoff interval
+bool busLoadMayTransmit(uint8_t len);
+
+// Accessors: total utilisation of the line (0..100) and the current backoff interval
+uint8_t busLoadUtilPct();
+uint16_t busLoadBackoffMs();
+
+// Bus cadence: the BLE module's control frame (0x20/0x65) comes at a steady period and
+// opens our TX slot; the answers follow. Returns the predicted quiet time in us before
+// that window (CFG_BUS_SLOT_GUARD_US ahead of the next control frame until
+// CFG_BUS_SLOT_HOLD_US after it), 0 inside the window, BUS_GAP_UNKNOWN if no cadence
+// has been seen. Long work (display flushes) should fit in it.
+static const uint32_t BUS_GAP_UNKNOWN = 0xFFFFFFFFUL;
+uint32_t busLoadGapUs();
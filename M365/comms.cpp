@@ -1,83 +1,225 @@
 #include "comms.h"
+#include "uart_tx.h"
+#include "bus_load.h"
+#include "idle_mode.h"
+#include "device_info.h"
+#include "ride_metrics.h"
+#include "render_task.h"
+
+// Queued scooter setting writes. The write goes out in the next TX slot ahead of any
+// poll, the register is read back in the slot after that, and the write is repeated
+// until the read-back matches or the retry budget is spent.
+enum { CQ_WRITE, CQ_READBACK, CQ_VERIFY };
+struct CMDQ_t { uint8_t cmd, state, tries; uint32_t since; };
+static CMDQ_t s_cmdQ[CFG_CMD_QUEUE_LEN];
+static uint8_t s_cmdHead = 0, s_cmdCount = 0;
+
+#if RENDER_TASK
+// queueCommand() is called from the render task
+static portMUX_TYPE s_cmdMux = portMUX_INITIALIZER_UNLOCKED;
+  #define CMDQ_LOCK()   portENTER_CRITICAL(&s_cmdMux)
+  #define CMDQ_UNLOCK() portEXIT_CRITICAL(&s_cmdMux)
+#else
+  #define CMDQ_LOCK()
+  #define CMDQ_UNLOCK()
+#endif
+
+static bool commandTarget(uint8_t cmd, uint8_t &param, int16_t &value) {
+  switch(cmd){
+    case CMD_CRUISE_ON:  param = 0x7C; value = 1; break;
+    case CMD_CRUISE_OFF: param = 0x7C; value = 0; break;
+    case CMD_LED_ON:     param = 0x7D; value = 2; break;
+    case CMD_LED_OFF:    param = 0x7D; value = 0; break;
+    case CMD_WEAK:       param = 0x7B; value = 0; break;
+    case CMD_MEDIUM:     param = 0x7B; value = 1; break;
+    case CMD_STRONG:     param = 0x7B; value = 2; break;
+    default: return false;
+  }
+  return true;
+}
+
+// Poll table index that reads back a settings register (0x7B..0x7D)
+static uint8_t readbackIndex(uint8_t param) {
+  for (uint8_t i = 0; i < sizeof(_q); i++)
+    if (pgm_read_byte_near(&_q[i]) == param) return i;
+  return 0xFF;
+}
+
+static void commandPop() {
+  s_cmdHead = (s_cmdHead + 1) % CFG_CMD_QUEUE_LEN;
+  s_cmdCount--;
+}
+
+static void commandRetry(CMDQ_t &c) {
+  if (++c.tries > CFG_CMD_RETRIES) commandPop(); else c.state = CQ_WRITE;
+}
+
+static bool commandQueue(uint8_t cmd) {
+  uint8_t param, qparam; int16_t value;
+  if (!commandTarget(cmd, param, value)) return false;
+  // A newer request for the same register replaces the pending one
+  for (uint8_t i = 0; i < s_cmdCount; i++) {
+    CMDQ_t &c = s_cmdQ[(s_cmdHead + i) % CFG_CMD_QUEUE_LEN];
+    if (commandTarget(c.cmd, qparam, value) && qparam == param) {
+      c.cmd = cmd; c.state = CQ_WRITE; c.tries = 0;
+      return true;
+    }
+  }
+  if (s_cmdCount >= CFG_CMD_QUEUE_LEN) return false;
+  CMDQ_t &c = s_cmdQ[(s_cmdHead + s_cmdCount) % CFG_CMD_QUEUE_LEN];
+  c.cmd = cmd; c.state = CQ_WRITE; c.tries = 0;
+  s_cmdCount++;
+  return true;
+}
+
+bool queueCommand(uint8_t cmd) {
+  CMDQ_LOCK();
+  bool ok = commandQueue(cmd);
+  CMDQ_UNLOCK();
+  return ok;
+}
+
+uint8_t commandsPending() { return s_cmdCount; }
+
+// Claims the TX slot for the head command when it needs one; returns true if it did
+static bool commandStep() {
+  if (s_cmdCount == 0) return false;
+  CMDQ_t &c = s_cmdQ[s_cmdHead];
+  uint8_t param; int16_t value;
+  commandTarget(c.cmd, param, value);
+  switch (c.state) {
+    case CQ_WRITE:
+      prepareCommand(c.cmd);
+      c.state = CQ_READBACK;
+      return true;
+    case CQ_READBACK:
+      if (preloadQueryFromTable(readbackIndex(param)) != 0) { commandPop(); return false; }
+      _Query.prepared = 1;
+      c.state = CQ_VERIFY;
+      c.since = millis();
+      return true;
+    case CQ_VERIFY:
+      // Keep polling while the answer is outstanding
+      if (millis() - c.since >= CFG_CMD_VERIFY_TIMEOUT_MS) commandRetry(c);
+      return false;
+  }
+  return false;
+}
+
+static bool commandService() {
+  CMDQ_LOCK();
+  bool claimed = commandStep();
+  CMDQ_UNLOCK();
+  return claimed;
+}
+
+static void commandVerify(uint8_t reg, uint8_t* data, uint8_t len) {
+  if (s_cmdCount == 0 || len < 2) return;
+  CMDQ_t &c = s_cmdQ[s_cmdHead];
+  uint8_t param; int16_t value, got;
+  if (c.state != CQ_VERIFY || !commandTarget(c.cmd, param, value) || param != reg) return;
+  memcpy((void*)&got, (void*)data, sizeof(got));
+  if (got == value) commandPop(); else commandRetry(c);
+}
 
 void dataFSM() {
-  static uint8_t   step = 0, _step = 0, entry = 1;
-  static uint32_t   beginMillis;
-  static uint8_t   Buf[RECV_BUFLEN];
-  static uint8_t* _bufPtr;
-  _bufPtr = (uint8_t*)&Buf;
-
-  switch (step) {
-    case 0:
-      while (XIAOMI_PORT.available() >= 2)
-        if (XIAOMI_PORT.read() == 0x55 && XIAOMI_PORT.peek() == 0xAA) {
-          XIAOMI_PORT.read();
-          step = 1;
-          break;
-        }
-      break;
-    case 1: {
-      static uint8_t   readCounter;
-      static uint16_t    _cs;
-      static uint8_t* bufPtr;
-      static uint8_t* asPtr;
-      uint8_t bt;
-      if (entry) {
-        memset((void*)&AnswerHeader, 0, sizeof(AnswerHeader));
-        bufPtr = _bufPtr;
-        readCounter = 0;
-        beginMillis = millis();
-        asPtr = (uint8_t*)&AnswerHeader;
-        _cs = 0xFFFF;
-      }
-      if (readCounter >= RECV_BUFLEN) { step = 2; break; }
-      if (millis() - beginMillis >= RECV_TIMEOUT) { step = 2; break; }
-      while (XIAOMI_PORT.available()) {
-        bt = XIAOMI_PORT.read();
-        readCounter++;
-        if (readCounter <= sizeof(AnswerHeader)) {
-          *asPtr++ = bt;
-          _cs -= bt;
-        }
-        if (readCounter > sizeof(AnswerHeader)) {
-          *bufPtr++ = bt;
-          if(readCounter < (AnswerHeader.len + 3)) _cs -= bt;
-        }
-        beginMillis = millis();
-      }
-      if (AnswerHeader.len == (readCounter - 4)) {
-        uint16_t cs;
-        uint16_t* ipcs;
-        ipcs = (uint16_t*)(bufPtr-2);
-        cs = *ipcs;
-        if(cs != _cs) { step = 2; break; }
-        processPacket(_bufPtr, readCounter);
-        step = 2;
+  static m365proto::Decoder<RECV_BUFLEN> rx;
+  static uint32_t lastByteMillis;
+
+  // Drop a partial frame when the line goes quiet mid-frame
+  if (rx.busy() && millis() - lastByteMillis >= RECV_TIMEOUT) rx.reset();
+
+  while (XIAOMI_PORT.available()) {
+    uint8_t bt = XIAOMI_PORT.read();
+    busLoadOnRx(1);
+    lastByteMillis = millis();
+    switch (rx.push(bt)) {
+      case m365proto::RX_FRAME:
+        if (uartRxIsEcho(rx.header(), rx.payload())) break;
+        AnswerHeader = rx.header();
+        processPacket((uint8_t*)rx.payload(), rx.payloadLen() + sizeof(AnswerHeader) + 2);
         break;
-      }
-      break; }
-    case 2:
-      step = 0;
-      break;
+      case m365proto::RX_BAD_CHECKSUM:
+      case m365proto::RX_OVERSIZE:
+        busLoadOnChecksumError();
+        break;
+      default:
+        break;
+    }
   }
+}
+
+#if RENDER_TASK
+// Frames that arrived while the render task held the state lock; applied in order on
+// a later pass. When full the oldest is dropped, newer telemetry supersedes it anyway.
+static const uint8_t DEFER_FRAMES = 4;
+struct DEFERRED_t { m365proto::FrameHeader h; uint8_t len; uint8_t data[RECV_BUFLEN]; };
+static DEFERRED_t s_defer[DEFER_FRAMES];
+static uint8_t s_deferHead = 0, s_deferCount = 0;
 
-  if (_step != step) { _step = step; entry = 1; } else entry = 0;
+static void deferPacket(const m365proto::FrameHeader& h, const uint8_t* data, uint8_t len) {
+  if (s_deferCount == DEFER_FRAMES) { s_deferHead = (s_deferHead + 1) % DEFER_FRAMES; s_deferCount--; }
+  DEFERRED_t &d = s_defer[(s_deferHead + s_deferCount) % DEFER_FRAMES];
+  d.h = h; d.len = len;
+  memcpy(d.data, data, len);
+  s_deferCount++;
+}
+#endif
+
+static void applyPacket(const m365proto::FrameHeader& h, uint8_t* data, uint8_t RawDataLen);
+
+// Caller holds the state lock
+static void applyDeferred() {
+#if RENDER_TASK
+  while (s_deferCount) {
+    DEFERRED_t &d = s_defer[s_deferHead];
+    applyPacket(d.h, d.data, d.len);
+    s_deferHead = (s_deferHead + 1) % DEFER_FRAMES;
+    s_deferCount--;
+  }
+#endif
+}
+
+void dataApplyDeferred() {
+#if RENDER_TASK
+  if (s_deferCount == 0 || !renderTryLock()) return;
+  applyDeferred();
+  renderUnlock();
+#endif
 }
 
 void processPacket(uint8_t* data, uint8_t len) {
   uint8_t RawDataLen;
   RawDataLen = len - sizeof(AnswerHeader) - 2;
+  busLoadOnFrame(AnswerHeader.addr, AnswerHeader.hz, AnswerHeader.cmd);
+  idleOnFrame();
+
+  // Our TX slot follows the BLE control frame; this never waits for anything
+  if (AnswerHeader.addr == 0x20 && AnswerHeader.cmd == 0x00 && AnswerHeader.hz == 0x65 &&
+      _Query.prepared == 1 && !_Hibernate && busLoadMayTransmit(_Query.DataLen + 4)) writeQuery();
+
+#if RENDER_TASK
+  if (!renderTryLock()) { deferPacket(AnswerHeader, data, RawDataLen); return; }
+  applyDeferred();
+  applyPacket(AnswerHeader, data, RawDataLen);
+  renderUnlock();
+#else
+  applyPacket(AnswerHeader, data, RawDataLen);
+#endif
+}
 
-  switch (AnswerHeader.addr) {
+// Store a frame's contents in the telemetry globals
+static void applyPacket(const m365proto::FrameHeader& h, uint8_t* data, uint8_t RawDataLen) {
+  switch (h.addr) {
     case 0x20:
-      switch (AnswerHeader.cmd) {
+      switch (h.cmd) {
         case 0x00:
-          switch (AnswerHeader.hz) {
+          switch (h.hz) {
             case 0x64:
               break;
             case 0x65:
-              if (_Query.prepared == 1 && !_Hibernate) writeQuery();
-              memcpy((void*)& S20C00HZ65, (void*)data, RawDataLen);
+              if (RawDataLen == sizeof(A20C00HZ65))
+                memcpy((void*)& S20C00HZ65, (void*)data, RawDataLen);
               break;
             default:
               break;
@@ -88,11 +230,12 @@ void processPacket(uint8_t* data, uint8_t len) {
       }
       break;
     case 0x21:
-      switch (AnswerHeader.cmd) {
+      switch (h.cmd) {
         case 0x00:
-        switch(AnswerHeader.hz) {
+        switch(h.hz) {
           case 0x64:
-            memcpy((void*)& S21C00HZ64, (void*)data, RawDataLen);
+            if (RawDataLen == sizeof(S21C00HZ64_t))
+              memcpy((void*)& S21C00HZ64, (void*)data, RawDataLen);
             break;
           }
           break;
@@ -103,7 +246,7 @@ void processPacket(uint8_t* data, uint8_t len) {
     case 0x22:
       break;
     case 0x23:
-      switch (AnswerHeader.cmd) {
+      switch (h.cmd) {
         case 0x3E:
           if (RawDataLen == sizeof(A23C3E)) 
             memcpy((void*)& S23C3E, (void*)data, RawDataLen);
@@ -120,12 +263,22 @@ void processPacket(uint8_t* data, uint8_t len) {
           if (RawDataLen == sizeof(A23C3A)) 
             memcpy((void*)& S23C3A, (void*)data, RawDataLen);
           break;
+        case 0x7B:
+        case 0x7C:
+        case 0x7D:
+          CMDQ_LOCK();
+          commandVerify(h.cmd, data, RawDataLen);
+          CMDQ_UNLOCK();
+          break;
+        case 0x10:
+          deviceInfoOnEsc(data, RawDataLen);
+          break;
         default:
           break;
       }
       break;
     case 0x25:
-      switch (AnswerHeader.cmd) {
+      switch (h.cmd) {
         case 0x40:
           if(RawDataLen == sizeof(A25C40)) 
             memcpy((void*)& S25C40, (void*)data, RawDataLen);
@@ -134,6 +287,9 @@ void processPacket(uint8_t* data, uint8_t len) {
           if (RawDataLen == sizeof(A25C31)) 
             memcpy((void*)& S25C31, (void*)data, RawDataLen);
           break;
+        case 0x10:
+          deviceInfoOnBms(data, RawDataLen);
+          break;
         default:
           break;
         }
@@ -143,14 +299,19 @@ void processPacket(uint8_t* data, uint8_t len) {
   }
 
   for (uint8_t i = 0; i < sizeof(_commandsWeWillSend); i++)
-    if (AnswerHeader.cmd == pgm_read_byte_near(&_q[_commandsWeWillSend[i]])) {
+    if (h.cmd == pgm_read_byte_near(&_q[_commandsWeWillSend[i]])) {
       _NewDataFlag = 1;
+      rideMetricsUpdate();
       break;
     }
 }
 
 void prepareNextQuery() {
   static uint8_t index = 0;
+  if (commandService()) return;
+  // One-off device info reads (boot only) also go ahead of the regular rotation
+  uint8_t info = deviceInfoPendingQuery();
+  if (info != 0xFF) { if (preloadQueryFromTable(info) == 0) _Query.prepared = 1; return; }
   _Query._dynQueries[0] = 1;
   _Query._dynQueries[1] = 8;
   _Query._dynQueries[2] = 10;
@@ -162,93 +323,44 @@ void prepareNextQuery() {
 }
 
 uint8_t preloadQueryFromTable(unsigned char index) {
-  uint8_t* ptrBuf;
-  uint8_t* pp;
-  uint8_t* ph;
-  uint8_t* pe;
-
-  uint8_t cmdFormat;
-  uint8_t hLen;
-  uint8_t eLen;
+  uint8_t frameLen;
 
   if (index >= sizeof(_q)) return 1;
   if (_Query.prepared != 0) return 2;
-  cmdFormat = pgm_read_byte_near(_f + index);
-
-  pp = (uint8_t*)&_h0;
-  ph = NULL;
-  pe = NULL;
 
-  switch(cmdFormat) {
+  uint8_t reg = pgm_read_byte_near(_q + index);
+  uint8_t len = pgm_read_byte_near(_l + index);
+  switch (pgm_read_byte_near(_f + index)) {
     case 1:
-      ph = (uint8_t*)&_h1;
-      hLen = sizeof(_h1);
-      pe = NULL;
+      frameLen = m365proto::encodeBmsRead(_Query.buf, reg, len);
       break;
     case 2:
-      ph = (uint8_t*)&_h2;
-      hLen = sizeof(_h2);
-      _end20t.hz = 0x02;
-      _end20t.th = S20C00HZ65.throttle;
-      _end20t.br = S20C00HZ65.brake;
-      pe = (uint8_t*)&_end20t;
-      eLen = sizeof(_end20t);
+      frameLen = m365proto::encodeEscRead(_Query.buf, reg, len, S20C00HZ65.throttle, S20C00HZ65.brake);
       break;
+    default:
+      return 1;
   }
-
-  ptrBuf = (uint8_t*)&_Query.buf;
-  memcpy_P((void*)ptrBuf, (void*)pp, sizeof(_h0));
-  ptrBuf += sizeof(_h0);
-  memcpy_P((void*)ptrBuf, (void*)ph, hLen);
-  ptrBuf += hLen;
-  memcpy_P((void*)ptrBuf, (void*)(_q + index), 1);
-  ptrBuf++;
-  memcpy_P((void*)ptrBuf, (void*)(_l + index), 1);
-  ptrBuf++;
-  if (pe != NULL) {
-    memcpy((void*)ptrBuf, (void*)pe, eLen);
-    ptrBuf+= eLen;
-  }
-  _Query.DataLen = ptrBuf - (uint8_t*)&_Query.buf[2];
-  _Query.cs = calcCs((uint8_t*)&_Query.buf[2], _Query.DataLen);
+  _Query.DataLen = frameLen - 4;
   return 0;
 }
 
 void prepareCommand(uint8_t cmd) {
-  uint8_t* ptrBuf;
-  _cmd.len  = 4;
-  _cmd.addr = 0x20;
-  _cmd.rlen = 0x03;
-  switch(cmd){
-    case CMD_CRUISE_ON:  _cmd.param = 0x7C; _cmd.value = 1; break;
-    case CMD_CRUISE_OFF: _cmd.param = 0x7C; _cmd.value = 0; break;
-    case CMD_LED_ON:     _cmd.param = 0x7D; _cmd.value = 2; break;
-    case CMD_LED_OFF:    _cmd.param = 0x7D; _cmd.value = 0; break;
-    case CMD_WEAK:       _cmd.param = 0x7B; _cmd.value = 0; break;
-    case CMD_MEDIUM:     _cmd.param = 0x7B; _cmd.value = 1; break;
-    case CMD_STRONG:     _cmd.param = 0x7B; _cmd.value = 2; break;
-    default: return;
-  }
-  ptrBuf = (uint8_t*)&_Query.buf;
-  memcpy_P((void*)ptrBuf, (void*)_h0, sizeof(_h0));
-  ptrBuf += sizeof(_h0);
-  memcpy((void*)ptrBuf, (void*)&_cmd, sizeof(_cmd));
-  ptrBuf += sizeof(_cmd);
-  _Query.DataLen = ptrBuf - (uint8_t*)&_Query.buf[2];
-  _Query.cs = calcCs((uint8_t*)&_Query.buf[2], _Query.DataLen);
+  uint8_t param; int16_t value;
+  if (!commandTarget(cmd, param, value)) return;
+  _Query.DataLen = m365proto::encodeEscWrite(_Query.buf, param, value) - 4;
   _Query.prepared = 1;
 }
 
 void writeQuery() {
-  RX_DISABLE;
-  XIAOMI_PORT.write((uint8_t*)&_Query.buf, _Query.DataLen + 2);
-  XIAOMI_PORT.write((uint8_t*)&_Query.cs, 2);
-  RX_ENABLE;
-  _Query.prepared = 0;
+  // The whole frame goes out at once; if the UART is still busy the query stays
+  // prepared and goes out in the next slot
+  uint8_t n = _Query.DataLen + 4;
+  if (uartTxSend(_Query.buf, n)) {
+    busLoadOnTx(_Query.buf, n);
+    _Query.prepared = 0;
+  }
 }
 
 uint16_t calcCs(uint8_t* data, uint8_t len) {
-  uint16_t cs = 0xFFFF;
-  for (uint8_t i = len; i > 0; i--) cs -= *data++;
-  return cs;
+  return m365proto::checksum(data, len);
 }
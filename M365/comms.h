@@ -6,6 +6,8 @@ void dataFSM();
 
 // Packet processing
 void processPacket(uint8_t* data, uint8_t len);
+// Render task builds: apply frames that arrived while the state lock was held
+void dataApplyDeferred();
 
 // Query preparation cycle
 void prepareNextQuery();
@@ -15,6 +17,11 @@ uint8_t preloadQueryFromTable(unsigned char index);
 
 // Prepare and send commands
 void prepareCommand(uint8_t cmd);
+
+// Queue a scooter setting (CMD_*). It is written ahead of the next poll, read back
+// from the ESC and re-sent until it verifies. Returns false if the queue is full.
+bool queueCommand(uint8_t cmd);
+uint8_t commandsPending();
 void writeQuery();
 
 // Checksum helper
@@ -82,6 +82,130 @@
 #define OLED_I2C_ADDRESS 0x3C
 #endif
 
+// OLED controller: 0 = SSD1306 (0.96" modules), 1 = SH1106 (most 1.3" modules). The
+// SH1106 has page addressing only and 132 columns of RAM, of which columns 2..129 are
+// visible; the display's cursor commands handle both, so partial updates work the same. The SH1106 is
+// specified up to 400 kHz on I2C, which caps the clock ladder below.
+#ifndef CFG_OLED_SH1106
+#define CFG_OLED_SH1106 0
+#endif
+
+// OLED on SPI instead of I2C (7-pin modules). On ESP32 the frames go out through the
+// SPI master driver with DMA (spi_dma.h) at CFG_OLED_SPI_HZ, queued and sent in the
+// background; CFG_OLED_SPI_DMA 0 uses the library's blocking SPI driver instead.
+#ifndef CFG_OLED_SPI
+#define CFG_OLED_SPI 0
+#endif
+#ifndef CFG_OLED_SPI_DMA
+#define CFG_OLED_SPI_DMA 1
+#endif
+#ifndef CFG_OLED_SPI_HZ
+#define CFG_OLED_SPI_HZ 10000000L   // SSD1306 limit (100 ns clock cycle)
+#endif
+#if defined(ARDUINO_ARCH_ESP32)
+  #ifndef OLED_SPI_CS_PIN
+  #define OLED_SPI_CS_PIN 5
+  #endif
+  #ifndef OLED_SPI_DC_PIN
+  #define OLED_SPI_DC_PIN 4
+  #endif
+  #ifndef OLED_SPI_RST_PIN
+  #define OLED_SPI_RST_PIN 19
+  #endif
+  #ifndef OLED_SPI_SCK_PIN
+  #define OLED_SPI_SCK_PIN 18
+  #endif
+  #ifndef OLED_SPI_MOSI_PIN
+  #define OLED_SPI_MOSI_PIN 23
+  #endif
+#else
+  // Hardware SPI: SCK 13, MOSI 11
+  #ifndef OLED_SPI_CS_PIN
+  #define OLED_SPI_CS_PIN 10
+  #endif
+  #ifndef OLED_SPI_DC_PIN
+  #define OLED_SPI_DC_PIN 8
+  #endif
+  #ifndef OLED_SPI_RST_PIN
+  #define OLED_SPI_RST_PIN 9
+  #endif
+#endif
+
+// OLED shadow framebuffer: drawing goes to RAM and only changed column runs are sent
+// (flicker-free redraws). 0=off, 1=full 1 KB copy, 2=per-segment hashes (~530 B RAM)
+#ifndef CFG_OLED_SHADOW
+  #if defined(ARDUINO_ARCH_ESP32)
+    #define CFG_OLED_SHADOW 1
+  #else
+    #define CFG_OLED_SHADOW 2
+  #endif
+#endif
+
+// AVR: drive the OLED through an interrupt-driven TWI queue (twi_queue.h) instead of
+// Wire, so frames are sent in the background while the bus keeps being served.
+// 0 = blocking Wire transfers. CFG_TWI_QUEUE_LEN: power of two, at most 256 bytes.
+#ifndef CFG_OLED_TWI_ASYNC
+  #if defined(ARDUINO_ARCH_AVR)
+    #define CFG_OLED_TWI_ASYNC 1
+  #else
+    #define CFG_OLED_TWI_ASYNC 0
+  #endif
+#endif
+#ifndef CFG_TWI_QUEUE_LEN
+#define CFG_TWI_QUEUE_LEN 128
+#endif
+
+// I2C clock for the OLED: steps through 100k, 400k, 700k and 1 MHz (up to
+// CFG_I2C_MAX_HZ), going up after CFG_I2C_STEP_UP_S seconds of display traffic
+// without errors and down when more than CFG_I2C_ERR_PCT % of the transactions in a
+// half-second window fail. The fastest step that held for a minute is kept in
+// EEPROM and used from the next boot on. AVR stays at 400 kHz or less.
+#ifndef CFG_I2C_MAX_HZ
+  #if defined(ARDUINO_ARCH_ESP32)
+    #define CFG_I2C_MAX_HZ 1000000L
+  #else
+    #define CFG_I2C_MAX_HZ 400000L
+  #endif
+#endif
+#ifndef CFG_I2C_STEP_UP_S
+#define CFG_I2C_STEP_UP_S 8
+#endif
+#ifndef CFG_I2C_ERR_PCT
+#define CFG_I2C_ERR_PCT 2
+#endif
+
+// OLED I2C health: the panel is re-initialized (and the bus recovered) after
+// CFG_OLED_FAIL_STREAK display transactions in a row have failed. The bus is only
+// pinged when the display has written nothing for CFG_OLED_PING_S seconds.
+#ifndef CFG_OLED_FAIL_STREAK
+#define CFG_OLED_FAIL_STREAK 3
+#endif
+#ifndef CFG_OLED_PING_S
+#define CFG_OLED_PING_S 10
+#endif
+
+// ESP32: run displayFSM(), the OLED flush and the AHT10 in their own FreeRTOS task so the
+// loop task only serves the bus (pinned to the other core; on single-core chips it runs
+// below the loop task's priority). Needs CFG_OLED_SHADOW. CFG_RENDER_POLL_MS is how often
+// the task asks the frame scheduler for a frame.
+#ifndef CFG_RENDER_TASK
+#define CFG_RENDER_TASK 0
+#endif
+#ifndef CFG_RENDER_POLL_MS
+#define CFG_RENDER_POLL_MS 5
+#endif
+
+// Frame scheduler: target interval per screen (ms). Throttle/brake changes draw at once.
+#ifndef CFG_FRAME_MS_RIDE
+#define CFG_FRAME_MS_RIDE 33         // big speed/current screen
+#endif
+#ifndef CFG_FRAME_MS_MAIN
+#define CFG_FRAME_MS_MAIN 50         // main screen
+#endif
+#ifndef CFG_FRAME_MS_SLOW
+#define CFG_FRAME_MS_SLOW 200        // menus, odometer, stats and info screens
+#endif
+
 // Optional AHT10 ambient temp/humidity sensor on the same I2C bus (ESP32 only)
 #ifndef CFG_AHT10_ENABLE
 #define CFG_AHT10_ENABLE 1   // 1=enable on ESP32 builds; 0=disable and hide from UI
@@ -98,6 +222,87 @@
 #define M365_UART_TX_PIN 17
 #endif
 
+// =========================
+// Scooter Commands
+// =========================
+// Cruise/taillight/KERS writes are queued ahead of polls and verified by reading
+// the ESC register back (0x7B..0x7D). Unconfirmed writes are re-sent.
+#ifndef CFG_CMD_QUEUE_LEN
+#define CFG_CMD_QUEUE_LEN 4
+#endif
+#ifndef CFG_CMD_RETRIES
+#define CFG_CMD_RETRIES 3            // re-sends after the first attempt
+#endif
+#ifndef CFG_CMD_VERIFY_TIMEOUT_MS
+#define CFG_CMD_VERIFY_TIMEOUT_MS 300 // wait for the read-back answer
+#endif
+
+// =========================
+// Bus Load
+// =========================
+// The bus is shared with the stock BLE module and often a phone app. Our polls are
+// limited to a share of the 115200 baud line and back off (doubling the gap between
+// our frames, up to CFG_BUS_BACKOFF_MAX_MS) while the bus looks congested.
+#ifndef CFG_BUS_OWN_BUDGET_PCT
+#define CFG_BUS_OWN_BUDGET_PCT 10    // max share of the line used by our own frames
+#endif
+#ifndef CFG_BUS_BUSY_PCT
+#define CFG_BUS_BUSY_PCT 60          // total utilisation that counts as congested
+#endif
+#ifndef CFG_BUS_ERR_PER_S
+#define CFG_BUS_ERR_PER_S 3          // checksum errors per second that count as congested
+#endif
+#ifndef CFG_BUS_FOREIGN_PER_S
+#define CFG_BUS_FOREIGN_PER_S 5      // foreign requests/answers per second (app traffic)
+#endif
+#ifndef CFG_BUS_BACKOFF_MAX_MS
+#define CFG_BUS_BACKOFF_MAX_MS 500
+#endif
+// Display work is fitted between our TX slots: none from CFG_BUS_SLOT_GUARD_US before
+// the BLE control frame until CFG_BUS_SLOT_HOLD_US after it (our TX and the answers)
+#ifndef CFG_BUS_SLOT_GUARD_US
+#define CFG_BUS_SLOT_GUARD_US 1500
+#endif
+#ifndef CFG_BUS_SLOT_HOLD_US
+#define CFG_BUS_SLOT_HOLD_US 6000
+#endif
+
+// =========================
+// Idle Mode
+// =========================
+// Parked and powered: after CFG_IDLE_TIMEOUT_MS without speed, current or
+// throttle/brake input, poll and redraw slowly and sleep between loop passes.
+#ifndef CFG_IDLE_TIMEOUT_MS
+#define CFG_IDLE_TIMEOUT_MS 30000UL
+#endif
+#ifndef CFG_IDLE_POLL_MS
+#define CFG_IDLE_POLL_MS 1000        // one query per interval while idle
+#endif
+#ifndef CFG_IDLE_FRAME_MS
+#define CFG_IDLE_FRAME_MS 500        // display redraw interval while idle
+#endif
+#ifndef CFG_IDLE_CURRENT_CA
+#define CFG_IDLE_CURRENT_CA 100      // |current| above this (centi-amps) counts as activity
+#endif
+#ifndef CFG_IDLE_SLEEP_MS
+#define CFG_IDLE_SLEEP_MS 2          // ESP32 yield per idle loop pass
+#endif
+
+// =========================
+// Load Graph
+// =========================
+// Alternate screen with power (or current, following the main screen's W/A setting)
+// over the last CFG_GRAPH_SECONDS: 128 columns, each the highest load of its slice.
+#ifndef CFG_GRAPH_SECONDS
+#define CFG_GRAPH_SECONDS 64         // time across the screen (0.5 s per column)
+#endif
+#ifndef CFG_GRAPH_FULL_W
+#define CFG_GRAPH_FULL_W 1000        // power at the top of the plot
+#endif
+#ifndef CFG_GRAPH_FULL_A
+#define CFG_GRAPH_FULL_A 30          // current at the top of the plot
+#endif
+
 // =========================
 // Regional / Units
 // =========================
@@ -17,26 +17,39 @@
   namespace WatchDog { inline void init(void (*)(void), uint32_t) {} }
 #endif
 
-// Display config: choose one
-//#define DISPLAY_SPI
-#define DISPLAY_I2C
+// Display bus: I2C unless CFG_OLED_SPI (config.h)
+#if CFG_OLED_SPI
+  #define DISPLAY_SPI
+#else
+  #define DISPLAY_I2C
+#endif
 
 #include "SSD1306Ascii.h"
 #ifdef DISPLAY_SPI
-  #include <SPI.h>
-  #include "SSD1306AsciiSpi.h"
-  #define PIN_CS  10
-  #define PIN_RST 9
-  #define PIN_DC  8
-  #define PIN_D0 13
-  #define PIN_D1 11
+  #if defined(ARDUINO_ARCH_ESP32) && CFG_OLED_SPI_DMA
+    #define OLED_SPI_DMA
+    #include "spi_dma.h"
+  #else
+    #include <SPI.h>
+    #include "SSD1306AsciiSpi.h"
+  #endif
+  #define PIN_CS  OLED_SPI_CS_PIN
+  #define PIN_RST OLED_SPI_RST_PIN
+  #define PIN_DC  OLED_SPI_DC_PIN
 #endif
 #ifdef DISPLAY_I2C
-  #include <Wire.h>
-  #include "SSD1306AsciiWire.h"
+  #if defined(ARDUINO_ARCH_AVR) && CFG_OLED_TWI_ASYNC
+    // Own TWI driver; Wire must not be linked (both claim TWI_vect)
+    #define OLED_TWI_ASYNC
+    #include "twi_queue.h"
+  #else
+    #include <Wire.h>
+    #include "SSD1306AsciiWire.h"
+  #endif
   // Default SSD1306 I2C address
   // Address comes from config.h (OLED_I2C_ADDRESS)
 #endif
+#include "oled_display.h"
 
 // Fonts
 #include "fonts/m365.h"
@@ -51,6 +64,7 @@
 #include <EEPROM.h>
 #include "language.h"
 #include "messages.h"
+#include "m365proto.h"
 
 #ifdef M365_DEFINE_GLOBALS
   MessagesClass Message;
@@ -61,7 +75,7 @@
 // Shared prototypes
 void oledInit(bool showLogo = true);
 void oledService();
-bool i2cCheckAndRecover();
+bool oledRecovering();
 bool displayClear(byte ID = 1, bool force = false);
 
 // Config/state
@@ -102,7 +116,7 @@ bool displayClear(byte ID = 1, bool force = false);
 
 // UI alternate screens and per-trip metrics (since power on)
 #ifdef M365_DEFINE_GLOBALS
-  uint8_t uiAltScreen = 0; // 0=main, 1=trip stats, 2=odometer, 3=temperatures
+  uint8_t uiAltScreen = 0; // 0=main, 1=trip stats, 2=odometer, 3=temperatures (ESP32), UI_SCREEN_GRAPH=load graph, UI_SCREEN_INFO=device info
   uint32_t tripEnergy_Wh_x100 = 0; // hundredths of Wh
   uint32_t lastPowerOnTime_s = 0;
   uint16_t tripMaxCurrent_cA = 0; // centi-amps
@@ -119,6 +133,15 @@ bool displayClear(byte ID = 1, bool force = false);
   extern uint16_t tripMaxVoltage_cV;
 #endif
 
+// Alternate screen count by platform (ESP32 has the extra temperatures screen)
+#if defined(ARDUINO_ARCH_ESP32)
+  #define UI_SCREEN_GRAPH 4
+#else
+  #define UI_SCREEN_GRAPH 3
+#endif
+#define UI_SCREEN_INFO (UI_SCREEN_GRAPH + 1)
+#define UI_SCREEN_COUNT (UI_SCREEN_INFO + 1)
+
 // Brake hold detection state (for cycling screens)
 #ifdef M365_DEFINE_GLOBALS
   bool brakeHoldArmed = false;
@@ -143,16 +166,16 @@ bool displayClear(byte ID = 1, bool force = false);
 
 #ifdef DISPLAY_SPI
   #ifdef M365_DEFINE_GLOBALS
-    SSD1306AsciiSpi display;
+    OledDisplay display;
   #else
-    extern SSD1306AsciiSpi display;
+    extern OledDisplay display;
   #endif
 #endif
 #ifdef DISPLAY_I2C
   #ifdef M365_DEFINE_GLOBALS
-    SSD1306AsciiWire display;
+    OledDisplay display;
   #else
-    extern SSD1306AsciiWire display;
+    extern OledDisplay display;
   #endif
 #endif
 
@@ -182,6 +205,7 @@ bool displayClear(byte ID = 1, bool force = false);
   #include <WebServer.h>
   #include <Update.h>
   #define XIAOMI_PORT Serial1
+  #define XIAOMI_UART_NUM UART_NUM_1 // IDF port behind XIAOMI_PORT
   #ifndef M365_UART_RX_PIN
     #define M365_UART_RX_PIN 16
   #endif
@@ -256,7 +280,9 @@ bool displayClear(byte ID = 1, bool force = false);
   #define EEPROM_COMMIT()  ((void)0)
 #endif
 
-struct QUERY_t { uint8_t prepared, DataLen; uint8_t buf[16]; uint16_t cs; uint8_t _dynQueries[5]; uint8_t _dynSize; };
+// buf holds the complete frame (sync to checksum); DataLen counts len..payload, so the
+// frame is DataLen + 4 bytes
+struct QUERY_t { uint8_t prepared, DataLen; uint8_t buf[16]; uint8_t _dynQueries[5]; uint8_t _dynSize; };
 #ifdef M365_DEFINE_GLOBALS
   QUERY_t _Query = {0};
 #else
@@ -270,12 +296,6 @@ struct QUERY_t { uint8_t prepared, DataLen; uint8_t buf[16]; uint16_t cs; uint8_
 #endif
 
 enum {CMD_CRUISE_ON, CMD_CRUISE_OFF, CMD_LED_ON, CMD_LED_OFF, CMD_WEAK, CMD_MEDIUM, CMD_STRONG};
-struct __attribute__((packed)) CMD{ uint8_t len, addr, rlen, param; int16_t value; };
-#ifdef M365_DEFINE_GLOBALS
-  CMD _cmd = {0};
-#else
-  extern CMD _cmd;
-#endif
 
 #ifdef M365_DEFINE_GLOBALS
   extern const uint8_t _commandsWeWillSend[3] = {1, 8, 10};
@@ -283,28 +303,13 @@ struct __attribute__((packed)) CMD{ uint8_t len, addr, rlen, param; int16_t valu
   extern const uint8_t _commandsWeWillSend[3];
 #endif
 
+// Poll table. 15/16 read register 0x10 (serial/firmware/capacity) of BMS and ESC once per boot.
 #ifdef M365_DEFINE_GLOBALS
-  extern const uint8_t _q[15] PROGMEM = {0x3B, 0x31, 0x20, 0x1B, 0x10, 0x1A, 0x69, 0x3E, 0xB0, 0x23, 0x3A, 0x7B, 0x7C, 0x7D, 0x40};
-  extern const uint8_t _l[15] PROGMEM = {   2,   10,    6,    4,   18,   12,    2,    2,   32,    6,    4,    2,    2,    2,   30};
-  extern const uint8_t _f[15] PROGMEM = {   1,    1,    1,    1,    1,    2,    2,    2,    2,    2,    2,    2,    2,    2,    1};
-#else
-  extern const uint8_t _q[15] PROGMEM; extern const uint8_t _l[15] PROGMEM; extern const uint8_t _f[15] PROGMEM;
-#endif
-
-#ifdef M365_DEFINE_GLOBALS
-  extern const uint8_t _h0[2] PROGMEM = {0x55, 0xAA};
-  extern const uint8_t _h1[3] PROGMEM = {0x03, 0x22, 0x01};
-  extern const uint8_t _h2[3] PROGMEM = {0x06, 0x20, 0x61};
-  extern const uint8_t _hc[3] PROGMEM = {0x04, 0x20, 0x03};
+  extern const uint8_t _q[17] PROGMEM = {0x3B, 0x31, 0x20, 0x1B, 0x10, 0x1A, 0x69, 0x3E, 0xB0, 0x23, 0x3A, 0x7B, 0x7C, 0x7D, 0x40, 0x10, 0x10};
+  extern const uint8_t _l[17] PROGMEM = {   2,   10,    6,    4,   18,   12,    2,    2,   32,    6,    4,    2,    2,    2,   30,   34,   22};
+  extern const uint8_t _f[17] PROGMEM = {   1,    1,    1,    1,    1,    2,    2,    2,    2,    2,    2,    2,    2,    2,    1,    1,    2};
 #else
-  extern const uint8_t _h0[2] PROGMEM; extern const uint8_t _h1[3] PROGMEM; extern const uint8_t _h2[3] PROGMEM; extern const uint8_t _hc[3] PROGMEM;
-#endif
-
-struct __attribute__ ((packed)) END20T_t{ uint8_t hz, th, br; };
-#ifdef M365_DEFINE_GLOBALS
-  END20T_t _end20t = {0,0,0};
-#else
-  extern END20T_t _end20t;
+  extern const uint8_t _q[17] PROGMEM; extern const uint8_t _l[17] PROGMEM; extern const uint8_t _f[17] PROGMEM;
 #endif
 
 #ifndef RECV_TIMEOUT
@@ -314,28 +319,35 @@ struct __attribute__ ((packed)) END20T_t{ uint8_t hz, th, br; };
 #define RECV_BUFLEN   64
 #endif
 
-struct __attribute__((packed)) ANSWER_HEADER{ uint8_t len, addr, hz, cmd; };
+// Frame and telemetry layouts live in m365proto.h (shared with the host tools)
+typedef m365proto::FrameHeader ANSWER_HEADER;
+typedef m365proto::A21C00HZ64 S21C00HZ64_t;
+using m365proto::A20C00HZ65;
+using m365proto::A25C31;
+using m365proto::A25C40;
+using m365proto::A23C3E;
+using m365proto::A23CB0;
+using m365proto::A23C23;
+using m365proto::A23C3A;
+
 #ifdef M365_DEFINE_GLOBALS
   ANSWER_HEADER AnswerHeader = {0,0,0,0};
 #else
   extern ANSWER_HEADER AnswerHeader;
 #endif
 
-struct __attribute__ ((packed)) S21C00HZ64_t { uint8_t state, ledBatt, headLamp, beepAction; };
 #ifdef M365_DEFINE_GLOBALS
   S21C00HZ64_t S21C00HZ64 = {0,0,0,0};
 #else
   extern S21C00HZ64_t S21C00HZ64;
 #endif
 
-struct __attribute__((packed)) A20C00HZ65 { uint8_t hz1, throttle, brake, hz2, hz3; };
 #ifdef M365_DEFINE_GLOBALS
   A20C00HZ65 S20C00HZ65 = {0,0,0,0,0};
 #else
   extern A20C00HZ65 S20C00HZ65;
 #endif
 
-struct __attribute__((packed)) A25C31 { uint16_t remainCapacity; uint8_t remainPercent, u4; int16_t current, voltage; uint8_t temp1, temp2; };
 #ifdef M365_DEFINE_GLOBALS
   A25C31 S25C31 = {0};
 #else
@@ -352,35 +364,30 @@ static inline int16_t totalCurrent_cA() {
   return (int16_t)sc;
 }
 
-struct __attribute__((packed)) A25C40 { int16_t c1,c2,c3,c4,c5,c6,c7,c8,c9,c10,c11,c12,c13,c14,c15; };
 #ifdef M365_DEFINE_GLOBALS
   A25C40 S25C40 = {0};
 #else
   extern A25C40 S25C40;
 #endif
 
-struct __attribute__((packed)) A23C3E { int16_t i1; };
 #ifdef M365_DEFINE_GLOBALS
   A23C3E S23C3E = {0};
 #else
   extern A23C3E S23C3E;
 #endif
 
-struct __attribute__((packed)) A23CB0 { uint8_t u1[10]; int16_t speed; uint16_t averageSpeed; uint32_t mileageTotal; uint16_t mileageCurrent; uint16_t elapsedPowerOnTime; int16_t mainframeTemp; uint8_t u2[8]; };
 #ifdef M365_DEFINE_GLOBALS
   A23CB0 S23CB0 = {{0},0,0,0,0,0,0,{0}};
 #else
   extern A23CB0 S23CB0;
 #endif
 
-struct __attribute__((packed)) A23C23 { uint8_t u1,u2,u3,u4; uint16_t remainMileage; };
 #ifdef M365_DEFINE_GLOBALS
   A23C23 S23C23 = {0,0,0,0,0};
 #else
   extern A23C23 S23C23;
 #endif
 
-struct __attribute__((packed)) A23C3A { uint16_t powerOnTime, ridingTime; };
 #ifdef M365_DEFINE_GLOBALS
   A23C3A S23C3A = {0,0};
 #else
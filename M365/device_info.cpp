@@ -0,0 +1,173 @@
+#include "device_info.h"
+#include "comms.h"
+#include "range_estimator.h"
+#include "ui_cache.h"
+#include "frame_sched.h"
+#include "line_buf.h"
+#include "oled_utils.h"
+
+// EEPROM layout: config 0..14, OLED I2C clock 15, range ring 64..193, device info from here
+// followed by its CRC16 (same as the range ring)
+static const int EEPROM_BASE = 200;
+
+// Boot-time reads: retried every RETRY_MS, at most MAX_TRIES per device
+static const uint16_t RETRY_MS = 1000;
+static const uint8_t MAX_TRIES = 5;
+
+// Poll-table entries for register 0x10 (see _q/_l/_f)
+static const uint8_t Q_BMS_INFO = 15;
+static const uint8_t Q_ESC_INFO = 16;
+
+// Answer layouts of register 0x10 (m365proto.h)
+using m365proto::A23C10;
+using m365proto::A25C10;
+
+static DEVINFO_t g_info = {{0},0,{0},0,0,0,0,0};
+static bool g_escDone = false, g_bmsDone = false;
+static uint8_t g_escTries = 0, g_bmsTries = 0;
+static uint32_t g_lastAsk = 0;
+static bool g_dirty = false;
+
+static void saveIfChanged() {
+  if (!g_dirty || !g_escDone || !g_bmsDone) return;
+  EEPROM.put(EEPROM_BASE, g_info);
+  EEPROM.put(EEPROM_BASE + (int)sizeof(g_info), crc16_ccitt_false((const uint8_t*)&g_info, sizeof(g_info)));
+  EEPROM_COMMIT();
+  g_dirty = false;
+}
+
+void deviceInfoInit() {
+  DEVINFO_t stored; uint16_t cs;
+  EEPROM.get(EEPROM_BASE, stored);
+  EEPROM.get(EEPROM_BASE + (int)sizeof(stored), cs);
+  if (cs == crc16_ccitt_false((const uint8_t*)&stored, sizeof(stored))) {
+    g_info = stored;
+    if (g_info.bmsCapacity) rangeSetPackCapacity(g_info.bmsCapacity);
+  }
+  g_escDone = g_bmsDone = false;
+  g_escTries = g_bmsTries = 0;
+}
+
+uint8_t deviceInfoPendingQuery() {
+  if (g_escDone && g_bmsDone) return 0xFF;
+  uint32_t now = millis();
+  if (g_lastAsk != 0 && (now - g_lastAsk) < RETRY_MS) return 0xFF;
+  if (!g_bmsDone && g_bmsTries < MAX_TRIES) { g_bmsTries++; g_lastAsk = now; return Q_BMS_INFO; }
+  if (!g_escDone && g_escTries < MAX_TRIES) { g_escTries++; g_lastAsk = now; return Q_ESC_INFO; }
+  // Out of attempts: keep whatever is cached for the one that did not answer, but
+  // still save what the other one reported
+  g_escDone = g_bmsDone = true;
+  saveIfChanged();
+  return 0xFF;
+}
+
+void deviceInfoOnEsc(uint8_t* data, uint8_t len) {
+  if (len != sizeof(A23C10)) return;
+  A23C10 a; memcpy((void*)&a, (void*)data, sizeof(a));
+  if (memcmp(g_info.escSerial, a.serial, sizeof(a.serial)) != 0 || g_info.escFw != a.fw) {
+    memcpy(g_info.escSerial, a.serial, sizeof(a.serial));
+    g_info.escFw = a.fw;
+    g_dirty = true;
+  }
+  g_escDone = true;
+  saveIfChanged();
+}
+
+void deviceInfoOnBms(uint8_t* data, uint8_t len) {
+  if (len != sizeof(A25C10)) return;
+  A25C10 a; memcpy((void*)&a, (void*)data, sizeof(a));
+  DEVINFO_t n = g_info;
+  memcpy(n.bmsSerial, a.serial, sizeof(a.serial));
+  n.bmsFw = a.fw; n.bmsCapacity = a.capacity; n.bmsCycles = a.cycles;
+  n.bmsCharges = a.charges; n.bmsProdDate = a.prodDate;
+  if (memcmp(&n, &g_info, sizeof(n)) != 0) { g_info = n; g_dirty = true; }
+  if (g_info.bmsCapacity) rangeSetPackCapacity(g_info.bmsCapacity);
+  g_bmsDone = true;
+  saveIfChanged();
+}
+
+const DEVINFO_t& deviceInfo() { return g_info; }
+
+uint16_t deviceInfoPackCapacity_mAh() {
+  return g_info.bmsCapacity ? g_info.bmsCapacity : (uint16_t)PACK1_MAH;
+}
+
+static void addSerial(LineBuf& line, const char* s) {
+  bool any = false;
+  for (uint8_t i = 0; i < 14; i++) {
+    if (s[i] < 0x20 || s[i] > 0x7E) break;
+    line.ch(s[i]); any = true;
+  }
+  if (!any) line.str(F("--"));
+}
+
+// Firmware words read as 0x0133 = 1.3.3
+static void addFw(LineBuf& line, uint16_t fw) {
+  line.num((fw >> 8) & 0x0F, FMT_INT1).ch('.');
+  line.num((fw >> 4) & 0x0F, FMT_INT1).ch('.');
+  line.num(fw & 0x0F, FMT_INT1);
+}
+
+static void drawRow(uint8_t row, const LineBuf& line) {
+  display.setCursor(0, row); display.print(line.c_str());
+}
+
+static void drawInfo() {
+  LineBuf line;
+  line.str(F("ESC ")); addSerial(line, g_info.escSerial); drawRow(0, line);
+  line.clear().str(F(" FW ")); addFw(line, g_info.escFw); drawRow(1, line);
+
+  line.clear().str(F("BMS ")); addSerial(line, g_info.bmsSerial); drawRow(3, line);
+  line.clear().str(F(" FW ")); addFw(line, g_info.bmsFw);
+  line.ch(' ').num(g_info.bmsCapacity, FMT_INT1).pstr(l_mah); drawRow(4, line);
+
+  line.clear().ch(' ').pstr(devCycles).num(g_info.bmsCycles, FMT_INT1);
+  line.ch(' ').pstr(devCharges).num(g_info.bmsCharges, FMT_INT1); drawRow(5, line);
+
+  // Production date: 7 bits year since 2000, 4 bits month, 5 bits day
+  uint16_t d = g_info.bmsProdDate;
+  uint8_t day = d & 0x1F, month = (d >> 5) & 0x0F; uint16_t year = 2000 + (d >> 9);
+  line.clear().ch(' ').pstr(devMade);
+  if (d == 0) line.str(F("--"));
+  else line.num(year, FMT_INT1).ch('-').num(month, FMT_ZERO2).ch('-').num(day, FMT_ZERO2);
+  drawRow(6, line);
+}
+
+#ifdef DISPLAY_I2C
+// OLED bus: clock, then recoveries with the last and worst duration
+static void drawI2c() {
+  const OLED_RECOVERY_t& rs = oledRecoveryStats();
+  uint16_t khz = (uint16_t)(i2cClockHz() / 1000);
+  struct { uint16_t khz; OLED_RECOVERY_t rs; } key = {khz, rs};
+  if (!uiFieldDirtyBuf(UIF_I2C, &key, sizeof(key))) return;
+  LineBuf line;
+  line.str(F("I2C ")).num(khz, FMT_INT1).ch('k');
+  if (rs.count) {
+    line.str(F(" R")).num(rs.count, FMT_INT1).ch(' ');
+    line.num(rs.lastMs, FMT_INT1).ch('/').num(rs.maxMs, FMT_INT1).str(F("ms"));
+  }
+  drawRow(2, line);
+  display.clearToEOL();
+}
+#endif
+
+void fsDeviceInfo() {
+  displayClear(14);
+  display.set1X(); display.setFont(defaultFont);
+  if (uiFieldDirtyBuf(UIF_DEVINFO, &g_info, sizeof(g_info))) drawInfo();
+#ifdef DISPLAY_I2C
+  drawI2c();
+#endif
+
+  // Display timing from the frame scheduler: mean/worst frame time and frames per second
+  const FRAME_STATS_t& fs = frameStats();
+  uint32_t avgMs = fs.avgUs / 1000, maxMs = fs.maxUs / 1000;
+  if (avgMs > 999) avgMs = 999;
+  if (maxMs > 999) maxMs = 999;
+  if (!uiFieldDirty(UIF_FRAME, ((uint32_t)fs.fps << 20) | (avgMs << 10) | maxMs)) return;
+  LineBuf line;
+  line.str(F("UI ")).num(avgMs, FMT_INT1).ch('/').num(maxMs, FMT_INT1).str(F("ms "));
+  line.num(fs.fps, FMT_INT1).str(F("fps"));
+  drawRow(7, line);
+  display.clearToEOL();
+}
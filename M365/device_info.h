@@ -0,0 +1,29 @@
+#pragma once
+#include "defines.h"
+
+// Static ESC/BMS identity (serials, firmware, pack capacity, cycles). Read once per
+// boot, kept in EEPROM and only rewritten when something changed (e.g. a swapped BMS).
+struct __attribute__((packed)) DEVINFO_t {
+  char escSerial[14]; uint16_t escFw;
+  char bmsSerial[14]; uint16_t bmsFw;
+  uint16_t bmsCapacity; uint16_t bmsCycles; uint16_t bmsCharges; uint16_t bmsProdDate;
+};
+
+// Load the cached record from EEPROM and arm the boot-time reads
+void deviceInfoInit();
+
+// Poll-table index of a pending device-info read, or 0xFF when nothing is due
+uint8_t deviceInfoPendingQuery();
+
+// Answer handlers for register 0x10 (ESC: addr 0x23, BMS: addr 0x25)
+void deviceInfoOnEsc(uint8_t* data, uint8_t len);
+void deviceInfoOnBms(uint8_t* data, uint8_t len);
+
+// Cached record; fields are zero until known
+const DEVINFO_t& deviceInfo();
+
+// Design capacity of the monitored pack (BMS), or PACK1_MAH until it is known
+uint16_t deviceInfoPackCapacity_mAh();
+
+// Draw the device info screen
+void fsDeviceInfo();
@@ -0,0 +1,44 @@
+#include "digit_blit.h"
+
+// 2X: a glyph byte is sent as two bytes per page, each nibble's bits doubled
+static const uint8_t SCALED_NIBBLE[16] PROGMEM = {
+  0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+  0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF
+};
+
+void blitText(const BlitFont& f, uint8_t col, uint8_t row, const char* s, uint8_t mag, const char* old) {
+  uint8_t n = (uint8_t)strlen(s);
+  uint8_t cell = (uint8_t)((f.width + 1) * mag);   // glyph and letter spacing
+  uint8_t from = 0, to = n;
+  if (old && strlen(old) == n) {
+    while (from < to && s[from] == old[from]) from++;
+    while (to > from && s[to - 1] == old[to - 1]) to--;
+  }
+
+  uint16_t x0 = col + (uint16_t)from * cell;
+  if (from < to && x0 < display.displayWidth()) {
+    for (uint8_t r = 0; r < f.pages; r++) {
+      for (uint8_t m = 0; m < mag; m++) {
+        uint8_t page = row + r * mag + m;
+        if (page >= display.displayRows()) break;
+        display.setCursor((uint8_t)x0, page);
+        for (uint8_t i = from; i < to; i++) {
+          uint8_t ch = (uint8_t)(s[i] - f.first);
+          const uint8_t* g = (ch < f.count) ? f.glyphs + ch * f.stride + r * f.width : nullptr;
+          for (uint8_t c = 0; c < f.width; c++) {
+            uint8_t b = g ? pgm_read_byte(g + c) : 0;
+            if (mag == 2) {
+              b = pgm_read_byte(&SCALED_NIBBLE[m ? b >> 4 : b & 0x0F]);
+              display.ssd1306WriteRamBuf(b);
+            }
+            display.ssd1306WriteRamBuf(b);
+          }
+          for (uint8_t k = 0; k < mag; k++) display.ssd1306WriteRamBuf(0);
+        }
+      }
+    }
+  }
+
+  uint16_t x1 = col + (uint16_t)n * cell;
+  display.setCursor(x1 < display.displayWidth() ? (uint8_t)x1 : display.displayWidth() - 1, row);
+}
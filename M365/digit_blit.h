@@ -0,0 +1,37 @@
+#pragma once
+#include "defines.h"
+
+// Fast path for the fixed-width number fonts (stdNumb, bigNumb, segNumb). print()
+// goes through the library's generic glyph engine, which reads the font header for
+// every character and moves the cursor once per glyph and page. blitText() sends the
+// whole string as one data run per page straight from the glyph bitmaps, and with the
+// text that is already on the panel it sends only the characters that changed:
+//
+//   blitText(BLIT_STD, 0, 0, line.c_str());            // setFont(stdNumb) + print()
+//   blitText(BLIT_BIG, 32, 0, "7", 1, "6");            // the changed digit only
+
+struct BlitFont {
+  const uint8_t* glyphs;   // first glyph bitmap (PROGMEM): pages rows of width bytes
+  uint8_t width;           // columns per glyph
+  uint8_t pages;           // pages per glyph at 1X
+  char first;              // first character in the font
+  uint8_t count;           // characters in the font
+  uint16_t stride;         // bytes per glyph
+};
+
+// Glyph addressing for a fixed-width font with this header (2 size bytes of 0, width,
+// height, first character, count), worked out at compile time
+constexpr BlitFont blitFont(const uint8_t* font, uint8_t w, uint8_t h, char first, uint8_t count) {
+  return BlitFont{font + 6, w, (uint8_t)((h + 7) / 8), first, count, (uint16_t)(w * ((h + 7) / 8))};
+}
+static constexpr BlitFont BLIT_STD = blitFont(stdNumb, 10, 14, ' ', 27);
+static constexpr BlitFont BLIT_BIG = blitFont(bigNumb, 28, 50, '0', 12);
+static constexpr BlitFont BLIT_SEG = blitFont(segNumb, 10, 14, '0', 12);
+
+// Draw s with its top page at row, at 1X or 2X (mag), pixel for pixel like print()
+// with letter spacing. Characters the font does not have are drawn blank. old is the
+// text last drawn at the same place and size; only the span from the first to the
+// last differing character is sent. Leaves the cursor after the text on row, as
+// print() does.
+void blitText(const BlitFont& f, uint8_t col, uint8_t row, const char* s, uint8_t mag = 1,
+              const char* old = nullptr);
@@ -2,81 +2,227 @@
 #include "comms.h"
 #include "battery_display.h"
 #include "aht10.h"
-
-// Main display function - handles all screen modes and user input
-void displayFSM() {
-  struct {
-    uint16_t curh; uint16_t curl; uint16_t pwh; uint16_t pwl;
-    uint16_t vh; uint16_t vl; uint32_t sph; uint16_t spl;
-    uint16_t milh; uint16_t mill; uint16_t Min; uint16_t Sec; uint16_t temp;
-  } m365_info;
-
-  int brakeVal = -1;
-  int throttleVal = -1;
-  int tmp_0, tmp_1;
-  long _speed;
-  long c_speed;
-
-  if (S23CB0.speed < -10000) {
-    c_speed = S23CB0.speed + 32768 + 32767;
-  } else {
-    c_speed = abs(S23CB0.speed);
+#include "device_info.h"
+#include "load_graph.h"
+#include "ride_metrics.h"
+#include "ui_cache.h"
+#include "line_buf.h"
+#include "digit_blit.h"
+
+// Main screen power: up to 9999 W right-aligned
+static constexpr NumFmt FMT_WATTS = {6, 0, ' '};
+
+// Big screen: character shown at each digit position, valid while UIF_BIG is drawn
+static char s_bigShown[4];
+
+// One big digit at its position in the selected style (bigNumb 1X or segNumb 2X);
+// sent only if it differs from what is shown there
+static void bigDigit(uint8_t i, uint8_t col, uint8_t row, char c, bool shown) {
+  char s[2] = {c, 0};
+  char old[2] = {s_bigShown[i], 0};
+  if (bigFontStyle == 0) blitText(BLIT_BIG, col, row, s, 1, shown ? old : nullptr);
+  else blitText(BLIT_SEG, col, row, s, 2, shown ? old : nullptr);
+  s_bigShown[i] = c;
+}
+
+// Main screen: text shown in the fields that change while riding, valid while the
+// field is drawn. Longer text is cut short, which only makes the next draw a full one.
+static char s_speedShown[8], s_timeShown[8], s_loadShown[8];
+
+static void remember(char (&shown)[8], const LineBuf& line) {
+  strncpy(shown, line.c_str(), sizeof(shown) - 1);
+  shown[sizeof(shown) - 1] = 0;
+}
+
+// Temperature in stdNumb, then the degree sign and unit in the default font
+static void printTemp(int16_t t) {
+  LineBuf line;
+  line.num(t, FMT_INT2);
+  display.setFont(stdNumb); display.print(line.c_str());
+  line.clear().ch((char)0x80);
+#ifdef US_Version
+  line.ch('F');
+#else
+  line.pstr(l_c);
+#endif
+  display.setFont(defaultFont); display.print(line.c_str());
+}
+
+bool screenLayout(uint8_t id, UiLayout& l) {
+  switch (id) {
+    case 0:
+      // Main: stdNumb fields (11 columns per character, 2 pages) at their narrowest
+      // format, e.g. " 0.0" for the speed and " 0.00" for the current
+      l.uses(0, 127, 0, 5);
+      l.paints(0, 43, 0, 1);      // speed (4 chars) or voltage (5)
+      l.paints(95, 116, 0, 1);    // temperature (2)
+      l.paints(0, 54, 2, 3);      // trip (5)
+      l.paints(0, 54, 4, 5);      // riding time (5)
+      l.paints(60, 114, 4, 5);    // current at 60 (5) or power at 55 (6)
+      bottomLayout(l);
+      return true;
+    case 4:
+      // Battery warning: one 128x64 glyph
+      l.uses(0, 127, 0, 7).paints(0, 127, 0, 7);
+      return true;
+    case 5: {
+      // Big value: only the digits that are always printed count as painted. Cells
+      // are the glyph and its letter spacing: bigNumb 28+1 columns, 7 pages; segNumb
+      // at 2X 2*(10+1) columns, 4 pages.
+      l.uses(0, 127, 0, 6);
+      bool seg = (bigFontStyle != 0);
+      uint8_t w = seg ? 22 : 29, h = seg ? 4 : 7;
+      if (bigMode == 1 && showPower) {
+        uint8_t y = seg ? 2 : 0;
+        l.paints(84, 84 + w - 1, y, y + h - 1);      // ones of the watts
+      } else {
+        l.paints(32, 32 + w - 1, 0, h - 1);          // ones
+        l.paints(75, 75 + w - 1, 0, h - 1);          // first decimal
+      }
+      bottomLayout(l);
+      return true;
+    }
+    default:
+      return false;
   }
+}
 
-  if (WheelSize) _speed = (long)c_speed * 10 / 8.5; else _speed = c_speed;
-  m365_info.sph = (uint32_t)abs(_speed) / 1000L;
-  m365_info.spl = (uint16_t)(abs(_speed) % 1000L) / 100;
-#ifdef US_Version
-  m365_info.sph = m365_info.sph/1.609; m365_info.spl = m365_info.spl/1.609;
+// Settings menu item idx, without the cursor column
+static void menuItemText(uint8_t idx, LineBuf& line) {
+  switch (idx) {
+    case 0: line.pstr(confScr1).pstr(autoBig ? l_Yes : l_No); break;
+    case 1: line.pstr(confScr2).pstr(bigMode == 1 ? confScr2b : confScr2a); break;
+    case 2: line.pstr(confScr3);
+      switch (warnBatteryPercent) { case 5: line.str(" 5%"); break; case 10: line.str("10%"); break; case 15: line.str("15%"); break; default: line.pstr(l_Off); } break;
+    case 3: line.pstr(confScr4).pstr(bigWarn ? l_Yes : l_No); break;
+    case 4: line.pstr(confScr5); break;
+    case 5: line.pstr(confScr6); break;
+#if defined(ARDUINO_ARCH_ESP32)
+    case 6: line.pstr(confScr10); break;
+    case 7: line.pstr(confScr9).pstr(showPower ? l_w : l_a); break;
+    case 8: line.pstr(confScr11).pstr(showVoltageMain ? confScr11b : confScr11a); break;
+    case 9: line.pstr(confScr12).pstr(bigFontStyle ? confScr12b : confScr12a); break;
+    case 10: line.pstr(confScr7).pstr(hibernateOnBoot ? l_Yes : l_No); break;
+    case 11: line.pstr(confScr13);
+      switch (mainTempSource) {
+        case 1: line.pstr(confScr13b); break;
+        case 2: line.pstr(confScr13c); break;
+#if CFG_AHT10_ENABLE
+        case 3: line.pstr(confScr13d); break;
 #endif
-  int16_t cur_cA_raw = totalCurrent_cA();
-  m365_info.curh = abs(cur_cA_raw) / 100;
-  m365_info.curl = abs(cur_cA_raw) % 100;
-  m365_info.vh = abs(S25C31.voltage) / 100;
-  m365_info.vl = abs(S25C31.voltage) % 100;
-  {
-    uint32_t ai = (uint32_t)abs(cur_cA_raw);
-    uint32_t vi = (uint32_t)abs(S25C31.voltage);
-    uint32_t m = (ai * vi + 50) / 100;
-    m365_info.pwh = (uint16_t)(m / 100);
-    m365_info.pwl = (uint16_t)(m % 100);
+        default: line.pstr(confScr13a); break;
+      }
+      break;
+    case 12: line.pstr(confScr8); break;
+#else
+    case 6: line.pstr(confScr9).pstr(showPower ? l_w : l_a); break;
+    case 7: line.pstr(confScr11).pstr(showVoltageMain ? confScr11b : confScr11a); break;
+    case 8: line.pstr(confScr12).pstr(bigFontStyle ? confScr12b : confScr12a); break;
+    case 9: line.pstr(confScr7).pstr(hibernateOnBoot ? l_Yes : l_No); break;
+    case 10: line.pstr(confScr8); break;
+#endif
+    default: break;
   }
+}
 
-  if ((m365_info.sph > 1) && Settings) { ShowBattInfo = false; M365Settings = false; Settings = false; }
+// M365 settings submenu item idx, without the cursor column
+static void m365ItemText(uint8_t idx, LineBuf& line) {
+  switch (idx) {
+    case 0: line.pstr(M365CfgScr1).pstr(cfgCruise ? l_On : l_Off); break;
+    case 1: line.pstr(M365CfgScr2); break;
+    case 2: line.pstr(M365CfgScr3).pstr(cfgTailight ? l_Yes : l_No); break;
+    case 3: line.pstr(M365CfgScr4); break;
+    case 4: line.pstr(M365CfgScr5);
+      switch (cfgKERS) { case 1: line.pstr(l_Medium); break; case 2: line.pstr(l_Strong); break; default: line.pstr(l_Weak); break; }
+      break;
+    case 5: line.pstr(M365CfgScr6); break;
+    case 6: line.pstr(M365CfgScr7).pstr(WheelSize ? l_10inch : l_85inch); break;
+    case 7: line.pstr(M365CfgScr8); break;
+    default: break;
+  }
+}
 
-  // Update per-trip aggregates (since power-on)
-  {
-    // Track energy: power (W) = current(A) * voltage(V). We have centi-units for I and V.
-    // Compute W*100 from m365_info.pwh/pwl => integer watts and fractional 0-99.
-    uint32_t P_Wx100 = (uint32_t)m365_info.pwh * 100UL + (uint32_t)m365_info.pwl;
-    // Integrate energy in Wh*100 using elapsed seconds since last sample of powerOnTime
-    uint32_t pot_s = S23C3A.powerOnTime; // seconds
-    // Detect wrap or reset (e.g. after power cycle)
-    if (lastPowerOnTime_s == 0 || pot_s < lastPowerOnTime_s) {
-      lastPowerOnTime_s = pot_s;
-      // Reset per-trip metrics when starting fresh
-      tripEnergy_Wh_x100 = 0;
-      tripMaxCurrent_cA = 0; tripMaxPower_Wx100 = 0;
-      tripMinVoltage_cV = 0xFFFF; tripMaxVoltage_cV = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+// WiFi submenu: its five items sit on rows 0, 2, 3, 5 and 7, the others stay blank
+static const uint8_t WIFI_ROW[5] = {0, 2, 3, 5, 7};
+
+static void wifiItemText(uint8_t row, LineBuf& line) {
+  switch (row) {
+    case 0: line.pstr(wifiMenu1).pstr(wifiEnabled ? l_On : l_Off); break;
+    case 2: line.pstr(wifiMenu2).ch(' ').str(otaSSID.c_str()); break;
+    case 3: line.pstr(wifiMenu3).ch(' ').str(otaPASS.c_str()); break;
+    case 5: line.pstr(wifiMenu4).str("192.168.4.1"); break;
+    case 7: line.pstr(wifiMenu5); break;
+    default: break;
+  }
+}
+#endif
+
+// Menu window. Rows are kept by content, so moving the selection only rewrites the
+// cursor glyph of two rows. Scrolling by one item moves the panel's display start line
+// (hardware scroll) and draws just the row that came into view. One window state
+// serves every menu: entering another menu's screen resets it.
+typedef void (*MenuText)(uint8_t idx, LineBuf& line);
+static uint8_t s_menuTop = 0, s_menuCursor = 0xFF, s_menuRowValid = 0;
+static uint32_t s_menuRowKey[8];
+
+static void menuDraw(MenuText itemText, uint8_t top, uint8_t totalItems, uint8_t cursor,
+                     bool entered) {
+  // display.clear() put the start line and page offset back to 0
+  if (entered) { s_menuTop = 0; s_menuCursor = 0xFF; s_menuRowValid = 0; }
+  if (top != s_menuTop) {
+    int8_t d = (int8_t)(top - s_menuTop);
+    if (d == 1 || d == -1) {
+      display.scrollMemory(d);
+      display.setStartLine(display.pageOffsetLine());
+      // The rows moved with the panel content; the one scrolled in is stale
+      if (d > 0) {
+        memmove(&s_menuRowKey[0], &s_menuRowKey[1], 7 * sizeof(s_menuRowKey[0]));
+        s_menuRowValid >>= 1;
+      } else {
+        memmove(&s_menuRowKey[1], &s_menuRowKey[0], 7 * sizeof(s_menuRowKey[0]));
+        s_menuRowValid = (uint8_t)(s_menuRowValid << 1);
+      }
+    } else {
+      s_menuRowValid = 0;
     }
-    uint32_t dt = (pot_s >= lastPowerOnTime_s) ? (pot_s - lastPowerOnTime_s) : 0;
-    if (dt > 0) {
-  // Wh = W * h; Wh*100 = (W*100) * (dt/3600)
-  tripEnergy_Wh_x100 += (P_Wx100 * dt) / 3600UL;
-      lastPowerOnTime_s = pot_s;
+    s_menuTop = top;
+  }
+
+  for (uint8_t row = 0; row < 8; row++) {
+    uint8_t idx = top + row;
+    if (idx >= totalItems) break;
+    LineBuf line;
+    itemText(idx, line);
+    uint32_t key = uiHash(line.c_str(), line.length()) ^ idx;
+    uint8_t bit = (uint8_t)(1 << row);
+    if (!(s_menuRowValid & bit) || s_menuRowKey[row] != key) {
+      display.setCursor(0, row);
+      display.print(idx == cursor ? (char)0x7E : ' ');
+      display.print(line.c_str());
+      display.clearToEOL();
+      s_menuRowKey[row] = key;
+      s_menuRowValid |= bit;
+    } else if (cursor != s_menuCursor && (idx == cursor || idx == s_menuCursor)) {
+      display.setCursor(0, row);
+      display.print(idx == cursor ? (char)0x7E : ' ');
     }
+  }
+  s_menuCursor = cursor;
+}
 
-    // Track max current and power (absolute discharge only)
-  uint16_t cur_cA = (uint16_t)abs(cur_cA_raw); // centi-amps (scaled total)
-    if (cur_cA > tripMaxCurrent_cA) tripMaxCurrent_cA = cur_cA;
-    uint32_t Pw_x100 = P_Wx100; // already W*100
-    if (Pw_x100 > tripMaxPower_Wx100) tripMaxPower_Wx100 = Pw_x100;
+// Main display function - handles all screen modes and user input
+void displayFSM() {
+  // Derived values come from the last telemetry frame (rideMetricsUpdate())
+  const RIDE_METRICS_t& m365_info = rideMetrics();
+  long c_speed = m365_info.speedRaw;
+  int16_t cur_cA_raw = m365_info.current_cA;
 
-    // Track min/max voltage
-    uint16_t v_cV = (uint16_t)abs(S25C31.voltage);
-    if (v_cV < tripMinVoltage_cV) tripMinVoltage_cV = v_cV;
-    if (v_cV > tripMaxVoltage_cV) tripMaxVoltage_cV = v_cV;
-  }
+  int brakeVal = -1;
+  int throttleVal = -1;
+  int tmp_0, tmp_1;
+
+  if ((m365_info.sph > 1) && Settings) { ShowBattInfo = false; M365Settings = false; Settings = false; }
 
   if ((c_speed <= 200) || Settings) {
     if (S20C00HZ65.brake > 60) brakeVal = 1; else if (S20C00HZ65.brake < 50) brakeVal = -1; else brakeVal = 0;
@@ -96,13 +242,7 @@ void displayFSM() {
       bool stationary = (c_speed <= 200);
       if (stationary) {
         // Determine number of screens by platform (ESP32 has extra temperatures screen)
-        uint8_t totalScreens =
-#if defined(ARDUINO_ARCH_ESP32)
-          4
-#else
-          3
-#endif
-        ;
+        uint8_t totalScreens = UI_SCREEN_COUNT;
         // Edge handlers based on config
         bool thEdge = (throttleVal == 1) && (oldThrottleVal != 1) && (brakeVal <= 0);
         bool brEdge = (brakeVal == 1) && (oldBrakeVal != 1) && (throttleVal <= 0);
@@ -130,51 +270,19 @@ void displayFSM() {
       if ((throttleVal == 1) && (oldThrottleVal != 1) && (brakeVal == -1) && (oldBrakeVal == -1))
       switch (sMenuPos) {
         case 0: cfgCruise = !cfgCruise; EEPROM.put(6, cfgCruise); EEPROM_COMMIT(); break;
-        case 1: if (cfgCruise) prepareCommand(CMD_CRUISE_ON); else prepareCommand(CMD_CRUISE_OFF); break;
+        case 1: if (cfgCruise) queueCommand(CMD_CRUISE_ON); else queueCommand(CMD_CRUISE_OFF); break;
         case 2: cfgTailight = !cfgTailight; EEPROM.put(7, cfgTailight); EEPROM_COMMIT(); break;
-        case 3: if (cfgTailight) prepareCommand(CMD_LED_ON); else prepareCommand(CMD_LED_OFF); break;
+        case 3: if (cfgTailight) queueCommand(CMD_LED_ON); else queueCommand(CMD_LED_OFF); break;
         case 4: switch (cfgKERS) { case 1: cfgKERS = 2; break; case 2: cfgKERS = 0; break; default: cfgKERS = 1; } EEPROM.put(8, cfgKERS); EEPROM_COMMIT(); break;
-        case 5: switch (cfgKERS) { case 1: prepareCommand(CMD_MEDIUM); break; case 2: prepareCommand(CMD_STRONG); break; default: prepareCommand(CMD_WEAK); } break;
+        case 5: switch (cfgKERS) { case 1: queueCommand(CMD_MEDIUM); break; case 2: queueCommand(CMD_STRONG); break; default: queueCommand(CMD_WEAK); } break;
         case 6: WheelSize = !WheelSize; EEPROM.put(5, WheelSize); EEPROM_COMMIT(); break;
         case 7: oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; timer = millis() + LONG_PRESS; M365Settings = false; break;
       } else if ((brakeVal == 1) && (oldBrakeVal != 1) && (throttleVal == -1) && (oldThrottleVal == -1)) { if (sMenuPos < 7) sMenuPos++; else sMenuPos = 0; timer = millis() + LONG_PRESS; }
 
-  if (displayClear(7)) sMenuPos = 0;
-  display.set1X(); display.setFont(defaultFont); display.setCursor(0, 0);
-      if (sMenuPos == 0) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr1);
-      display.print(cfgCruise ? (const __FlashStringHelper *) l_On : (const __FlashStringHelper *) l_Off);
-
-      display.setCursor(0, 1);
-      if (sMenuPos == 1) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr2);
-
-      display.setCursor(0, 2);
-      if (sMenuPos == 2) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr3);
-      display.print(cfgTailight ? (const __FlashStringHelper *) l_Yes : (const __FlashStringHelper *) l_No);
-
-      display.setCursor(0, 3);
-      if (sMenuPos == 3) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr4);
-
-      display.setCursor(0, 4);
-      if (sMenuPos == 4) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr5);
-      switch (cfgKERS) { case 1: display.print((const __FlashStringHelper *) l_Medium); break; case 2: display.print((const __FlashStringHelper *) l_Strong); break; default: display.print((const __FlashStringHelper *) l_Weak); break; }
-
-      display.setCursor(0, 5);
-      if (sMenuPos == 5) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr6);
-
-      display.setCursor(0, 6);
-      if (sMenuPos == 6) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr7);
-      if (WheelSize) display.print((const __FlashStringHelper *) l_10inch); else display.print((const __FlashStringHelper *) l_85inch);
-
-      display.setCursor(0, 7);
-      if (sMenuPos == 7) display.print((char)0x7E); else display.print(" ");
-      display.print((const __FlashStringHelper *) M365CfgScr8);
+      bool entered = displayClear(7);
+      if (entered) sMenuPos = 0;
+      display.set1X(); display.setFont(defaultFont);
+      menuDraw(m365ItemText, 0, 8, sMenuPos, entered);
 
       oldBrakeVal = brakeVal; oldThrottleVal = throttleVal;
       return;
@@ -182,50 +290,49 @@ void displayFSM() {
       if ((brakeVal == 1) && (oldBrakeVal != 1) && (throttleVal == -1) && (oldThrottleVal == -1)) { oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; timer = millis() + LONG_PRESS; ShowBattInfo = false; return; }
       fsBattInfo(); display.setCursor(0, 7); display.print((const __FlashStringHelper *) battScr); oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; return;
     } else if (Settings) {
-  // Disable long-press auto-exit from Settings to avoid unintended exits
-  // (Use explicit Save/Exit menu item instead)
+      // Disable long-press auto-exit from Settings to avoid unintended exits
+      // (Use explicit Save/Exit menu item instead)
 
       // Apply action on throttle press when brake is released (neutral or below)
       if ((throttleVal == 1) && (oldThrottleVal != 1) && (brakeVal <= 0) && (oldBrakeVal <= 0)) switch (menuPos) {
-  case 0: autoBig = !autoBig; break;
-  case 1: bigMode = (bigMode == 1) ? 0 : 1; break;
-  case 2: switch (warnBatteryPercent) { case 0: warnBatteryPercent = 5; break; case 5: warnBatteryPercent = 10; break; case 10: warnBatteryPercent = 15; break; default: warnBatteryPercent = 0; } break;
-  case 3: bigWarn = !bigWarn; break;
-  case 4: ShowBattInfo = true; break;
-  case 5: M365Settings = true; break;
+        case 0: autoBig = !autoBig; break;
+        case 1: bigMode = (bigMode == 1) ? 0 : 1; break;
+        case 2: switch (warnBatteryPercent) { case 0: warnBatteryPercent = 5; break; case 5: warnBatteryPercent = 10; break; case 10: warnBatteryPercent = 15; break; default: warnBatteryPercent = 0; } break;
+        case 3: bigWarn = !bigWarn; break;
+        case 4: ShowBattInfo = true; break;
+        case 5: M365Settings = true; break;
 #if defined(ARDUINO_ARCH_ESP32)
-  case 6: WiFiSettings = true; wifiMenuPos = 0; break;
-  case 7: showPower = !showPower; break;
-  case 8: showVoltageMain = !showVoltageMain; break;
-  case 9: bigFontStyle = (bigFontStyle == 0) ? 1 : 0; break;
-  case 10: hibernateOnBoot = !hibernateOnBoot; break;
-  case 11: {
-    // Cycle main temperature source (ESP32: 0..3)
-    uint8_t maxSrc =
+        case 6: WiFiSettings = true; wifiMenuPos = 0; break;
+        case 7: showPower = !showPower; break;
+        case 8: showVoltageMain = !showVoltageMain; break;
+        case 9: bigFontStyle = (bigFontStyle == 0) ? 1 : 0; break;
+        case 10: hibernateOnBoot = !hibernateOnBoot; break;
+        case 11: {
+          // Cycle main temperature source (ESP32: 0..3)
+          uint8_t maxSrc =
 #if CFG_AHT10_ENABLE
-  3
+            3;
 #else
-  2
+            2;
 #endif
-  ;
-    if (mainTempSource >= maxSrc) mainTempSource = 0; else mainTempSource++;
-    break;
-  }
-  case 12: EEPROM.put(1, autoBig); EEPROM.put(2, warnBatteryPercent); EEPROM.put(3, bigMode); EEPROM.put(4, bigWarn); EEPROM.put(9, hibernateOnBoot); EEPROM.put(10, showPower); EEPROM.put(11, wifiEnabled); EEPROM.put(12, showVoltageMain); EEPROM.put(13, bigFontStyle); EEPROM.put(14, mainTempSource); EEPROM_COMMIT(); Settings = false; break;
+          if (mainTempSource >= maxSrc) mainTempSource = 0; else mainTempSource++;
+          break;
+        }
+        case 12: EEPROM.put(1, autoBig); EEPROM.put(2, warnBatteryPercent); EEPROM.put(3, bigMode); EEPROM.put(4, bigWarn); EEPROM.put(9, hibernateOnBoot); EEPROM.put(10, showPower); EEPROM.put(11, wifiEnabled); EEPROM.put(12, showVoltageMain); EEPROM.put(13, bigFontStyle); EEPROM.put(14, mainTempSource); EEPROM_COMMIT(); Settings = false; break;
 #else
-  case 6: showPower = !showPower; break;
-  case 7: showVoltageMain = !showVoltageMain; break;
-  case 8: bigFontStyle = (bigFontStyle == 0) ? 1 : 0; break;
-  case 9: hibernateOnBoot = !hibernateOnBoot; break;
-  case 10: EEPROM.put(1, autoBig); EEPROM.put(2, warnBatteryPercent); EEPROM.put(3, bigMode); EEPROM.put(4, bigWarn); EEPROM.put(9, hibernateOnBoot); EEPROM.put(10, showPower); EEPROM.put(12, showVoltageMain); EEPROM.put(13, bigFontStyle); EEPROM.put(14, mainTempSource); EEPROM_COMMIT(); Settings = false; break;
+        case 6: showPower = !showPower; break;
+        case 7: showVoltageMain = !showVoltageMain; break;
+        case 8: bigFontStyle = (bigFontStyle == 0) ? 1 : 0; break;
+        case 9: hibernateOnBoot = !hibernateOnBoot; break;
+        case 10: EEPROM.put(1, autoBig); EEPROM.put(2, warnBatteryPercent); EEPROM.put(3, bigMode); EEPROM.put(4, bigWarn); EEPROM.put(9, hibernateOnBoot); EEPROM.put(10, showPower); EEPROM.put(12, showVoltageMain); EEPROM.put(13, bigFontStyle); EEPROM.put(14, mainTempSource); EEPROM_COMMIT(); Settings = false; break;
 #endif
       } else if ((brakeVal == 1) && (oldBrakeVal != 1) && (throttleVal <= 0) && (oldThrottleVal <= 0)) {
 #if defined(ARDUINO_ARCH_ESP32)
-  if (menuPos < 11)
+        if (menuPos < 11)
 #else
-  if (menuPos < 10)
+        if (menuPos < 10)
 #endif
-    menuPos++; else menuPos = 0; timer = millis() + LONG_PRESS;
+          menuPos++; else menuPos = 0; timer = millis() + LONG_PRESS;
       }
 
 #if defined(ARDUINO_ARCH_ESP32)
@@ -244,105 +351,36 @@ void displayFSM() {
         }
         if (otaPASS.length() == 0) otaPASS = "m365ota123";
 
-  displayClear(12);
-  display.set1X(); display.setFont(defaultFont); display.setCursor(0, 0);
-        display.print(wifiMenuPos == 0 ? (char)0x7E : ' ');
-        display.print((const __FlashStringHelper *) wifiMenu1);
-        display.print(wifiEnabled ? (const __FlashStringHelper *) l_On : (const __FlashStringHelper *) l_Off);
-
-        display.setCursor(0, 2);
-        display.print(wifiMenuPos == 1 ? (char)0x7E : ' ');
-        display.print((const __FlashStringHelper *) wifiMenu2); display.print(' '); display.print(otaSSID);
-
-        display.setCursor(0, 3);
-        display.print(wifiMenuPos == 2 ? (char)0x7E : ' ');
-        display.print((const __FlashStringHelper *) wifiMenu3); display.print(' '); display.print(otaPASS);
-
-        display.setCursor(0, 5);
-        display.print(wifiMenuPos == 3 ? (char)0x7E : ' ');
-        display.print((const __FlashStringHelper *) wifiMenu4); display.print("192.168.4.1");
-
-        display.setCursor(0, 7);
-        display.print(wifiMenuPos == 4 ? (char)0x7E : ' ');
-        display.print((const __FlashStringHelper *) wifiMenu5);
+        bool entered = displayClear(12);
+        display.set1X(); display.setFont(defaultFont);
+        menuDraw(wifiItemText, 0, 8, WIFI_ROW[wifiMenuPos], entered);
 
         oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; return;
       }
 #endif
 
       // Windowed rendering: only 8 visible lines, scroll as menuPos changes
-  displayClear(2);
-  display.set1X(); display.setFont(defaultFont);
+      bool entered = displayClear(2);
+      display.set1X(); display.setFont(defaultFont);
       // Determine total items depending on platform
-    uint8_t totalItems =
+      uint8_t totalItems =
 #if defined(ARDUINO_ARCH_ESP32)
-  13; // indices 0..12 (extra main temp source + save)
+        13; // indices 0..12 (extra main temp source + save)
 #else
-  11; // indices 0..10
+        11; // indices 0..10
 #endif
       // Compute top index so selection stays within window
       uint8_t top = 0;
       if (menuPos > 3) {
-  uint8_t maxTop = (totalItems > 8) ? (totalItems - 8) : 0;
-  uint8_t desired = menuPos - 3;
-  top = (desired > maxTop) ? maxTop : desired;
+        uint8_t maxTop = (totalItems > 8) ? (totalItems - 8) : 0;
+        uint8_t desired = menuPos - 3;
+        top = (desired > maxTop) ? maxTop : desired;
       }
+      menuDraw(menuItemText, top, totalItems, menuPos, entered);
 
-      // Helper lambda to draw one item at a given row
-      auto drawItem = [&](uint8_t idx, uint8_t row){
-  display.setCursor(0, row);
-  if (menuPos == idx) display.print((char)0x7E); else display.print(' ');
-  switch (idx) {
-    case 0: display.print((const __FlashStringHelper *) confScr1);
-      display.print(autoBig ? (const __FlashStringHelper *) l_Yes : (const __FlashStringHelper *) l_No); break;
-    case 1: display.print((const __FlashStringHelper *) confScr2);
-      switch (bigMode) { case 1: display.print((const __FlashStringHelper *) confScr2b); break; default: display.print((const __FlashStringHelper *) confScr2a); } break;
-    case 2: display.print((const __FlashStringHelper *) confScr3);
-      switch (warnBatteryPercent) { case 5: display.print(" 5%"); break; case 10: display.print("10%"); break; case 15: display.print("15%" ); break; default: display.print((const __FlashStringHelper *) l_Off); } break;
-    case 3: display.print((const __FlashStringHelper *) confScr4);
-      display.print(bigWarn ? (const __FlashStringHelper *) l_Yes : (const __FlashStringHelper *) l_No); break;
-    case 4: display.print((const __FlashStringHelper *) confScr5); break;
-    case 5: display.print((const __FlashStringHelper *) confScr6); break;
-#if defined(ARDUINO_ARCH_ESP32)
-    case 6: display.print((const __FlashStringHelper *) confScr10); break;
-    case 7: display.print((const __FlashStringHelper *) confScr9); display.print(showPower ? (const __FlashStringHelper *) l_w : (const __FlashStringHelper *) l_a); break;
-  case 8: display.print((const __FlashStringHelper *) confScr11); display.print(showVoltageMain ? (const __FlashStringHelper *) confScr11b : (const __FlashStringHelper *) confScr11a); break;
-  case 9: display.print((const __FlashStringHelper *) confScr12); display.print(bigFontStyle ? (const __FlashStringHelper *) confScr12b : (const __FlashStringHelper *) confScr12a); break;
-  case 10: display.print((const __FlashStringHelper *) confScr7); display.print(hibernateOnBoot ? (const __FlashStringHelper *) l_Yes : (const __FlashStringHelper *) l_No); break;
-  case 11: display.print((const __FlashStringHelper *) confScr13);
-    switch (mainTempSource) {
-      case 0: display.print((const __FlashStringHelper *) confScr13a); break;
-      case 1: display.print((const __FlashStringHelper *) confScr13b); break;
-      case 2: display.print((const __FlashStringHelper *) confScr13c); break;
-#if CFG_AHT10_ENABLE
-      case 3: display.print((const __FlashStringHelper *) confScr13d); break;
-#endif
-      default: display.print((const __FlashStringHelper *) confScr13a); break;
+      // Latch current input states for edge detection on next frame
+      oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; return;
     }
-    break;
-  case 12: display.print((const __FlashStringHelper *) confScr8); break;
-#else
-      case 6: display.print((const __FlashStringHelper *) confScr9); display.print(showPower ? (const __FlashStringHelper *) l_w : (const __FlashStringHelper *) l_a); break;
-      case 7: display.print((const __FlashStringHelper *) confScr11); display.print(showVoltageMain ? (const __FlashStringHelper *) confScr11b : (const __FlashStringHelper *) confScr11a); break;
-      case 8: display.print((const __FlashStringHelper *) confScr12); display.print(bigFontStyle ? (const __FlashStringHelper *) confScr12b : (const __FlashStringHelper *) confScr12a); break;
-      case 9: display.print((const __FlashStringHelper *) confScr7); display.print(hibernateOnBoot ? (const __FlashStringHelper *) l_Yes : (const __FlashStringHelper *) l_No); break;
-      case 10: display.print((const __FlashStringHelper *) confScr8); break;
-#endif
-    default: break;
-  }
-      };
-
-  for (uint8_t line = 0; line < 8; ++line) {
-  uint8_t idx = top + line;
-  if (idx >= totalItems) break;
-  drawItem(idx, line);
-      }
-
-  // Latch current input states for edge detection on next frame
-  oldBrakeVal = brakeVal; oldThrottleVal = throttleVal; return;
-
-  return;
-  }
 
     oldBrakeVal = brakeVal; oldThrottleVal = throttleVal;
   }
@@ -351,10 +389,22 @@ void displayFSM() {
     if (displayClear(4)) { display.setFont(m365); display.setCursor(0, 0); display.print((char)0x21); display.setFont(defaultFont); }
   } else if ((m365_info.sph > 1) && (autoBig)) {
     displayClear(5); display.set1X();
+    // Everything the big value shows, folded into one cache key: digits, unit blink
+    // and the regen marker
+    bool regen = (cur_cA_raw < 0);
+    bool unitOn = !regen || (millis() % 1000 < 500);
+    uint32_t bigKey = (bigMode == 1)
+      ? (showPower ? (0x40000000UL | m365_info.pwh) : (((uint32_t)m365_info.curh << 8) | m365_info.curl))
+      : (0x80000000UL | (m365_info.sph << 8) | m365_info.spl);
+    if (bigMode == 1) bigKey ^= ((uint32_t)regen << 28) | ((uint32_t)unitOn << 29);
+    // Digits already on the panel are kept if the same mode drew them
+    uint32_t shownKey;
+    bool shown = uiFieldDrawn(UIF_BIG, &shownKey) && ((shownKey ^ bigKey) & 0xC0000000UL) == 0;
+    if (uiFieldDirty(UIF_BIG, bigKey)) {
+    // Big digits reach into row 6; the range text there has to be drawn again on top
+    uiFieldInvalidate(UIF_RANGE);
   switch (bigMode) {
       case 1:
-    // Select font per setting: STD = bigNumb @ 1X, DIGIT = segNumb @ 2X
-    if (bigFontStyle == 0) { display.setFont(bigNumb); display.set1X(); } else { display.setFont(segNumb); display.set2X(); }
   if (showPower) {
           uint16_t W = m365_info.pwh; if (W > 9999) W = 9999;
           char buf[5]; buf[0] = (W >= 1000) ? char('0' + (W / 1000) % 10) : ' ';
@@ -363,23 +413,25 @@ void displayFSM() {
           buf[3] = char('0' + (W % 10)); buf[4] = 0;
           // Translate spaces to ';' (blank glyph) only for DIGIT
           if (bigFontStyle == 1) { for (uint8_t i = 0; i < 3; ++i) if (buf[i] == ' ') buf[i] = (char)0x3B; }
-          if (bigFontStyle == 0) { display.setFont(bigNumb); display.set1X(); } else { display.setFont(segNumb); display.set2X(); }
           uint8_t yDigits = (bigFontStyle == 0) ? 0 : 2;
-          display.setCursor(0, yDigits);  display.print(buf[0]);
-          display.setCursor(26, yDigits); display.print(buf[1]);
-          display.setCursor(54, yDigits); display.print(buf[2]);
-          display.setCursor(84, yDigits); display.print(buf[3]);
+          bigDigit(0, 0, yDigits, buf[0], shown);
+          bigDigit(1, 26, yDigits, buf[1], shown);
+          bigDigit(2, 54, yDigits, buf[2], shown);
+          bigDigit(3, 84, yDigits, buf[3], shown);
           uint8_t ux = display.col(); if (ux > 112) ux = 112;
           uint8_t yUnit = (bigFontStyle == 0) ? 4 : 4;
           display.setFont(defaultFont); display.setCursor(ux, yUnit); display.set2X(); display.print((const __FlashStringHelper *) l_w); display.set1X();
   } else {
           tmp_0 = m365_info.curh / 10; tmp_1 = m365_info.curh % 10;
-          display.setCursor(2, 0); if (tmp_0 > 0) display.print(tmp_0); else display.print(bigFontStyle == 1 ? (char)0x3B : ' ');
-          display.setCursor(32, 0); display.print(tmp_1);
+          bigDigit(0, 2, 0, (tmp_0 > 0) ? char('0' + tmp_0 % 10) : (bigFontStyle == 1 ? (char)0x3B : ' '), shown);
+          bigDigit(1, 32, 0, char('0' + tmp_1), shown);
           tmp_0 = m365_info.curl / 10; tmp_1 = m365_info.curl % 10;
-          display.setCursor(75, 0); display.print(tmp_0);
-          display.setCursor(108, 0); if (bigFontStyle == 0) { display.setFont(bigNumb); display.set1X(); } else { display.setFont(segNumb); display.set2X(); } display.print(tmp_1); display.setFont(defaultFont);
-          if ((cur_cA_raw >= 0) || ((cur_cA_raw < 0) && (millis() % 1000 < 500))) { display.set2X(); display.setCursor(108, (bigFontStyle == 0) ? 3 : 4); display.print((const __FlashStringHelper *) l_a); }
+          bigDigit(2, 75, 0, char('0' + tmp_0), shown);
+          // The unit and regen marker are drawn over the last digit: when either
+          // changes, the digit has to clear them first
+          bigDigit(3, 108, 0, char('0' + tmp_1), shown && ((shownKey ^ bigKey) & 0x30000000UL) == 0);
+          display.setFont(defaultFont);
+          if (unitOn) { display.set2X(); display.setCursor(108, (bigFontStyle == 0) ? 3 : 4); display.print((const __FlashStringHelper *) l_a); }
           display.set1X(); display.setCursor(64, 5); display.print((char)0x85);
         }
         display.setFont(defaultFont); display.set1X();
@@ -388,14 +440,14 @@ void displayFSM() {
         break;
       default:
   // Speed big mode
-  if (bigFontStyle == 0) { display.setFont(bigNumb); display.set1X(); } else { display.setFont(segNumb); display.set2X(); }
         tmp_0 = m365_info.sph / 10; tmp_1 = m365_info.sph % 10;
-        display.setCursor(2, 0); if (tmp_0 > 0) display.print(tmp_0); else display.print(bigFontStyle == 1 ? (char)0x3B : ' ');
-        display.setCursor(32, 0); display.print(tmp_1);
-        display.setCursor(75, 0); display.print(m365_info.spl);
-        display.setCursor(106, 0); display.print((char)0x3A);
+        bigDigit(0, 2, 0, (tmp_0 > 0) ? char('0' + tmp_0 % 10) : (bigFontStyle == 1 ? (char)0x3B : ' '), shown);
+        bigDigit(1, 32, 0, char('0' + tmp_1), shown);
+        bigDigit(2, 75, 0, char('0' + m365_info.spl % 10), shown);
+        bigDigit(3, 106, 0, (char)0x3A, shown);
   display.setFont(defaultFont); display.set1X(); display.setCursor(64, 5); display.print((char)0x85);
     }
+    }
   showBatt(S25C31.remainPercent, cur_cA_raw < 0);
   showRangeSmall();
   } else {
@@ -403,27 +455,47 @@ void displayFSM() {
       fsBattInfo();
     } else {
       // Decide which alt screen to render
-  uint8_t screenToShow = uiAltScreen; // 0 main, 1 trip stats, 2 odometer, 3 temperatures (ESP32 only)
-  if (screenToShow == 2) {
+  uint8_t screenToShow = uiAltScreen; // 0 main, 1 trip stats, 2 odometer, 3 temperatures (ESP32 only), UI_SCREEN_GRAPH load graph, UI_SCREEN_INFO device info
+  if (screenToShow == UI_SCREEN_INFO) {
+        fsDeviceInfo();
+        return;
+  } else if (screenToShow == UI_SCREEN_GRAPH) {
+        fsLoadGraph();
+        return;
+  } else if (screenToShow == 2) {
         // Odometer/power-on time screen (original triggered by throttle)
-        displayClear(3);
-        display.set1X(); display.setFont(defaultFont); display.setCursor(0, 0);
-        display.print((const __FlashStringHelper *) infoScr1); display.print(':');
-        display.setFont(stdNumb); display.setCursor(15, 1);
-        tmp_0 = S23CB0.mileageTotal / 1000; tmp_1 = (S23CB0.mileageTotal % 1000) / 10;
-        if (tmp_0 < 1000) display.print(' '); if (tmp_0 < 100) display.print(' '); if (tmp_0 < 10) display.print(' ');
-        display.print(tmp_0); display.print('.'); if (tmp_1 < 10) display.print('0'); display.print(tmp_1);
-        display.setFont(defaultFont); display.print((const __FlashStringHelper *) l_km);
-
-        display.setCursor(0, 5); display.print((const __FlashStringHelper *) infoScr2); display.print(':');
-        display.setFont(stdNumb); display.setCursor(15, 6);
-        tmp_0 = S23C3A.powerOnTime / 60; tmp_1 = S23C3A.powerOnTime % 60;
-        if (tmp_0 < 100) display.print(' '); if (tmp_0 < 10) display.print(' ');
-        display.print(tmp_0); display.print(':'); if (tmp_1 < 10) display.print('0'); display.print(tmp_1);
+        if (displayClear(3)) {
+          // Static labels
+          display.set1X(); display.setFont(defaultFont);
+          display.setCursor(0, 0); display.print((const __FlashStringHelper *) infoScr1); display.print(':');
+          display.setCursor(0, 5); display.print((const __FlashStringHelper *) infoScr2); display.print(':');
+        }
+        display.set1X();
+        if (uiFieldDirty(UIF_ODO_DIST, S23CB0.mileageTotal / 10)) {
+          display.setFont(stdNumb); display.setCursor(15, 1);
+          LineBuf line; line.num(S23CB0.mileageTotal / 10, FMT_FIX4_2);
+          display.print(line.c_str());
+          display.setFont(defaultFont); display.print((const __FlashStringHelper *) l_km);
+        }
+        if (uiFieldDirty(UIF_ODO_TIME, S23C3A.powerOnTime)) {
+          display.setFont(stdNumb); display.setCursor(15, 6);
+          LineBuf line; line.num(S23C3A.powerOnTime / 60, FMT_INT3).ch(':').num(S23C3A.powerOnTime % 60, FMT_ZERO2);
+          display.print(line.c_str());
+        }
         return;
   } else if (screenToShow == 1) {
         // Trip stats: Avg Wh/km, Max A/W, Umin and Umax (separate lines)
-        displayClear(6);
+        // (own screen ID: the battery info page used to share 6 and was never cleared)
+        if (displayClear(15)) {
+          // Static labels
+          display.set1X(); display.setFont(defaultFont);
+          display.setCursor(0, 0); display.print((const __FlashStringHelper *) statsAvgWhKm); display.print(':');
+          display.setCursor(0, 2);
+          if (!showPower) display.print((const __FlashStringHelper *) statsMaxA); else display.print((const __FlashStringHelper *) statsMaxW);
+          display.print(' ');
+          display.setCursor(0, 4); display.print((const __FlashStringHelper *) statsUmin); display.print(' ');
+          display.setCursor(0, 6); display.print((const __FlashStringHelper *) statsUmax); display.print(' ');
+        }
         display.set1X(); display.setFont(defaultFont);
         // mileageCurrent is km*100 (0.01 km units)
         uint32_t mCurr = S23CB0.mileageCurrent; // km*100
@@ -436,46 +508,50 @@ void displayFSM() {
           if (avg_u32 > 65535UL) avg_u32 = 65535UL;
           avg_whkm_x100 = (uint16_t)avg_u32;
         }
-        // Line 0: label and value on the same row
-        display.setFont(defaultFont); display.setCursor(0, 0); display.print((const __FlashStringHelper *) statsAvgWhKm); display.print(':');
-        display.setFont(defaultFont); display.setCursor(64, 0);
-        uint16_t av_i = avg_whkm_x100 / 100; uint16_t av_f = avg_whkm_x100 % 100;
-        if (av_i < 100) display.print(' '); if (av_i < 10) display.print(' ');
-        display.print(av_i); display.print('.'); if (av_f < 10) display.print('0'); display.print(av_f); display.print(' '); display.print(F("Wh/km"));
+        // Line 0: value next to its label
+        if (uiFieldDirty(UIF_TRIP_AVG, avg_whkm_x100)) {
+          display.setCursor(64, 0);
+          LineBuf line; line.num(avg_whkm_x100, FMT_FIX3_2).str(F(" Wh/km"));
+          display.print(line.c_str());
+        }
 
         // Line 2: Max current or power on same row
-        display.setFont(defaultFont); display.setCursor(0, 2);
-        if (!showPower) { display.print((const __FlashStringHelper *) statsMaxA); display.print(' '); display.setCursor(64, 2);
-          uint16_t c_i = tripMaxCurrent_cA / 100; uint16_t c_f = tripMaxCurrent_cA % 100;
-          if (c_i < 100) display.print(' '); if (c_i < 10) display.print(' ');
-          display.print(c_i); display.print('.'); if (c_f < 10) display.print('0'); display.print(c_f); display.print(' '); display.print((const __FlashStringHelper *) l_a);
-        } else { display.print((const __FlashStringHelper *) statsMaxW); display.print(' '); display.setCursor(64, 2);
-          uint32_t w100 = tripMaxPower_Wx100; uint16_t w_i = w100 / 100; uint16_t w_f = w100 % 100;
-          // fit in 4 digits + . + 2
-          if (w_i < 1000) display.print(' '); if (w_i < 100) display.print(' '); if (w_i < 10) display.print(' ');
-          display.print(w_i); display.print('.'); if (w_f < 10) display.print('0'); display.print(w_f); display.print(' '); display.print((const __FlashStringHelper *) l_w);
+        if (!showPower) {
+          if (uiFieldDirty(UIF_TRIP_MAX, tripMaxCurrent_cA)) {
+            display.setCursor(64, 2);
+            LineBuf line; line.num(tripMaxCurrent_cA, FMT_FIX3_2).ch(' ').pstr(l_a);
+            display.print(line.c_str());
+          }
+        } else if (uiFieldDirty(UIF_TRIP_MAX, tripMaxPower_Wx100)) {
+          display.setCursor(64, 2);
+          LineBuf line; line.num(tripMaxPower_Wx100, FMT_FIX4_2).ch(' ').pstr(l_w);
+          display.print(line.c_str());
         }
 
         // Line 4: Umin on its own line
-        display.setFont(defaultFont); display.setCursor(0, 4); display.print((const __FlashStringHelper *) statsUmin); display.print(' ');
-        display.setCursor(64, 4);
-        uint16_t vmin_i = (tripMinVoltage_cV == 0xFFFF) ? 0 : (tripMinVoltage_cV / 100);
-        uint16_t vmin_f = (tripMinVoltage_cV == 0xFFFF) ? 0 : (tripMinVoltage_cV % 100);
-        if (vmin_i < 10) display.print(' ');
-        display.print(vmin_i); display.print('.'); if (vmin_f < 10) display.print('0'); display.print(vmin_f); display.print(' '); display.print((const __FlashStringHelper *) l_v);
+        if (uiFieldDirty(UIF_TRIP_UMIN, tripMinVoltage_cV)) {
+          display.setCursor(64, 4);
+          LineBuf line; line.num(tripMinVoltage_cV == 0xFFFF ? 0 : tripMinVoltage_cV, FMT_FIX2_2).ch(' ').pstr(l_v);
+          display.print(line.c_str());
+        }
 
         // Line 6: Umax on its own line
-        display.setFont(defaultFont); display.setCursor(0, 6); display.print((const __FlashStringHelper *) statsUmax); display.print(' ');
-        display.setCursor(64, 6);
-        uint16_t vmax_i = tripMaxVoltage_cV / 100; uint16_t vmax_f = tripMaxVoltage_cV % 100;
-        if (vmax_i < 10) display.print(' ');
-        display.print(vmax_i); display.print('.'); if (vmax_f < 10) display.print('0'); display.print(vmax_f); display.print(' '); display.print((const __FlashStringHelper *) l_v);
+        if (uiFieldDirty(UIF_TRIP_UMAX, tripMaxVoltage_cV)) {
+          display.setCursor(64, 6);
+          LineBuf line; line.num(tripMaxVoltage_cV, FMT_FIX2_2).ch(' ').pstr(l_v);
+          display.print(line.c_str());
+        }
   return;
   }
 #if defined(ARDUINO_ARCH_ESP32)
   else if (screenToShow == 3) {
   // Temperatures screen: Batt T1/T2 and DRV temp
-  displayClear(13);
+  if (displayClear(13)) {
+    // Static labels
+    display.set1X(); display.setFont(defaultFont);
+    display.setCursor(0, 0); display.print((const __FlashStringHelper *) tempBatt);
+    display.setCursor(0, 3); display.print((const __FlashStringHelper *) tempDrv);
+  }
   display.set1X(); display.setFont(defaultFont);
 
   // Battery temps from S25C31.temp1/temp2 are raw Celsius degrees
@@ -488,53 +564,31 @@ void displayFSM() {
   auto c2f = [](int16_t c){ return (int16_t)(c * 9 / 5 + 32); };
   t1 = c2f(t1); t2 = c2f(t2); tdrv = c2f(tdrv);
 #endif
-  // Batt label
-  display.setCursor(0, 0); display.print((const __FlashStringHelper *) tempBatt);
   // Batt values under the label
-  display.setFont(stdNumb);
-  display.setCursor(0, 1);
-  if (t1 < 10 && t1 > -10) display.print(' ');
-  display.print(t1);
-  display.setFont(defaultFont); display.print((char)0x80);
-#ifdef US_Version
-  display.print('F');
-#else
-  display.print((const __FlashStringHelper *) l_c);
-#endif
-  display.setFont(stdNumb);
-  display.setCursor(87, 1);
-  if (t2 < 10 && t2 > -10) display.print(' ');
-  display.print(t2);
-  display.setFont(defaultFont); display.print((char)0x80);
-#ifdef US_Version
-  display.print('F');
-#else
-  display.print((const __FlashStringHelper *) l_c);
-#endif
+  if (uiFieldDirty(UIF_TEMP_BATT, ((uint32_t)(uint16_t)t1 << 16) | (uint16_t)t2)) {
+  display.setCursor(0, 1); printTemp(t1);
+  display.setCursor(87, 1); printTemp(t2);
+  }
 
-  // DRV label
-  display.setFont(defaultFont); display.setCursor(0, 3); display.print((const __FlashStringHelper *) tempDrv);
   // DRV value under the label
-  display.setFont(stdNumb); display.setCursor(0, 4);
-  if (tdrv < 10 && tdrv > -10) display.print(' ');
-  display.print(tdrv);
-  display.setFont(defaultFont); display.print((char)0x80);
-#ifdef US_Version
-  display.print('F');
-#else
-  display.print((const __FlashStringHelper *) l_c);
-#endif
+  if (uiFieldDirty(UIF_TEMP_DRV, (uint16_t)tdrv)) {
+  display.setCursor(0, 4); printTemp(tdrv);
+  }
 
 #if CFG_AHT10_ENABLE
   // Optional AHT10 ambient temp/humidity (ESP32 only)
-  if (g_ahtPresent) {
+  uint16_t rh_i = (uint16_t)(g_ahtHum + 0.5f);
+  if (rh_i > 100) rh_i = 100;
+  int16_t ta = (int16_t)(g_ahtTempC + (g_ahtTempC >= 0 ? 0.5f : -0.5f));
+#ifdef US_Version
+  ta = (int16_t)(ta * 9 / 5 + 32);
+#endif
+  if (g_ahtPresent && uiFieldDirty(UIF_TEMP_AMB, ((uint32_t)rh_i << 16) | (uint16_t)ta)) {
     // Draw to the right side to avoid overlap
     display.setFont(defaultFont);
   // Humidity: show integer RH and a big '%' next to it
   display.setCursor(64, 3); display.print("RH:");
   display.setFont(stdNumb); display.setCursor(87, 3);
-  uint16_t rh_i = (uint16_t)(g_ahtHum + 0.5f);
-  if (rh_i > 100) rh_i = 100;
   display.print(rh_i);
   // Append percent in large size (2X default font) at safe column
   uint8_t endCol = display.col(); if (endCol > 116) endCol = 116;
@@ -544,19 +598,7 @@ void displayFSM() {
 
   // Ambient temperature label under the RH area
   display.setCursor(64, 5); display.print("Amb:");
-  display.setFont(stdNumb); display.setCursor(87, 5);
-    int16_t ta = (int16_t)(g_ahtTempC + (g_ahtTempC >= 0 ? 0.5f : -0.5f));
-#ifdef US_Version
-    ta = (int16_t)(ta * 9 / 5 + 32);
-#endif
-    if (ta < 10 && ta > -10) display.print(' ');
-    display.print(ta);
-    display.setFont(defaultFont); display.print((char)0x80);
-#ifdef US_Version
-    display.print('F');
-#else
-    display.print((const __FlashStringHelper *) l_c);
-#endif
+  display.setCursor(87, 5); printTemp(ta);
   }
 #endif // CFG_AHT10_ENABLE
         return;
@@ -564,10 +606,6 @@ void displayFSM() {
 #endif
 
       displayClear(0);
-      m365_info.milh = S23CB0.mileageCurrent / 100;
-      m365_info.mill = S23CB0.mileageCurrent % 100;
-      m365_info.Min = S23C3A.ridingTime / 60;
-      m365_info.Sec = S23C3A.ridingTime % 60;
       // Select main temperature source
       int16_t tempC = S23CB0.mainframeTemp / 10; // DRV default
       switch (mainTempSource) {
@@ -578,43 +616,57 @@ void displayFSM() {
 #endif
   default: break; // DRV
       }
-      m365_info.temp = tempC;
 #ifdef US_Version
-      m365_info.milh = m365_info.milh/1.609; m365_info.mill = m365_info.mill/1.609; m365_info.temp = m365_info.temp*9/5+32;
+      tempC = tempC*9/5+32;
 #endif
-  display.set1X(); display.setFont(stdNumb); display.setCursor(0, 0);
+  display.set1X(); display.setFont(stdNumb);
+      // Each field is drawn with its unit and only when its value (or format) changed;
+      // speed, time and load send only the digits that differ from the shown text
+      uint32_t shownKey;
+      bool shown = uiFieldDrawn(UIF_SPEED, &shownKey);
+      if (uiFieldDirty(UIF_SPEED, showVoltageMain ? (0x80000000UL | ((uint32_t)m365_info.vh << 8) | m365_info.vl) : ((m365_info.sph << 8) | m365_info.spl))) {
+        LineBuf line;
       if (!showVoltageMain) {
-        if (m365_info.sph < 10) display.print(' ');
-        display.print(m365_info.sph); display.print('.'); display.print(m365_info.spl);
+        line.num((int32_t)m365_info.sph * 10 + m365_info.spl, FMT_FIX2_1);
+        blitText(BLIT_STD, 0, 0, line.c_str(), 1, shown ? s_speedShown : nullptr);
   display.setFont(defaultFont); display.print((const __FlashStringHelper *) l_kmh); display.setFont(stdNumb);
       } else {
-        uint16_t vh = m365_info.vh; uint16_t vl = m365_info.vl; if (vh < 10) display.print(' ');
-        display.print(vh); display.print('.'); if (vl < 10) display.print('0'); display.print(vl);
+        line.num((int32_t)m365_info.vh * 100 + m365_info.vl, FMT_FIX2_2);
+        blitText(BLIT_STD, 0, 0, line.c_str(), 1, shown ? s_speedShown : nullptr);
   uint8_t __ux = display.col(); uint8_t __uy = display.row(); display.setFont(defaultFont); display.setCursor(__ux, __uy + 1); display.print((const __FlashStringHelper *) l_v); display.setFont(stdNumb);
       }
-      display.setCursor(95, 0);
-      if (m365_info.temp < 10) display.print(' '); display.print(m365_info.temp);
+        remember(s_speedShown, line);
+      }
+      if (uiFieldDirty(UIF_TEMP, (uint16_t)tempC)) {
+      { LineBuf line; line.num(tempC, FMT_INT2); blitText(BLIT_STD, 95, 0, line.c_str()); }
   display.setFont(defaultFont); display.print((char)0x80); display.print((const __FlashStringHelper *) l_c); display.setFont(stdNumb);
-      display.setCursor(0, 2);
-      if (m365_info.milh < 10) display.print(' '); display.print(m365_info.milh); display.print('.'); if (m365_info.mill < 10) display.print('0'); display.print(m365_info.mill);
+      }
+      if (uiFieldDirty(UIF_TRIP, ((uint32_t)m365_info.milh << 8) | m365_info.mill)) {
+      { LineBuf line; line.num((int32_t)m365_info.milh * 100 + m365_info.mill, FMT_FIX2_2); blitText(BLIT_STD, 0, 2, line.c_str()); }
   { uint8_t __ux = display.col(); uint8_t __uy = display.row(); display.setFont(defaultFont); display.setCursor(__ux, __uy + 1); display.print((const __FlashStringHelper *) l_km); display.setFont(stdNumb); }
-      display.setCursor(0, 4);
-      if (m365_info.Min < 10) display.print('0'); display.print(m365_info.Min); display.print(':'); if (m365_info.Sec < 10) display.print('0'); display.print(m365_info.Sec);
+      }
+      shown = uiFieldDrawn(UIF_TIME, &shownKey);
+      if (uiFieldDirty(UIF_TIME, ((uint32_t)m365_info.Min << 8) | m365_info.Sec)) {
+      LineBuf line; line.num(m365_info.Min, FMT_ZERO2).ch(':').num(m365_info.Sec, FMT_ZERO2);
+      blitText(BLIT_STD, 0, 4, line.c_str(), 1, shown ? s_timeShown : nullptr);
+      remember(s_timeShown, line);
+      }
   display.setFont(stdNumb);
+  shown = uiFieldDrawn(UIF_LOAD, &shownKey);
   if (!showPower) {
-        display.setCursor(60, 4);
-        uint8_t startCol = display.col(); if (m365_info.curh < 10) display.print(' '); display.print(m365_info.curh); display.print('.'); if (m365_info.curl < 10) display.print('0'); display.print(m365_info.curl);
-        uint8_t endCol = display.col(); uint8_t printed = endCol - startCol; for (uint8_t k = printed; k < 7; k++) display.print(' ');
+      if (uiFieldDirty(UIF_LOAD, ((uint32_t)m365_info.curh << 8) | m365_info.curl)) {
+        LineBuf line; line.num((int32_t)m365_info.curh * 100 + m365_info.curl, FMT_FIX2_2);
+        blitText(BLIT_STD, 60, 4, line.c_str(), 1, shown && !(shownKey & 0x80000000UL) ? s_loadShown : nullptr);
+        remember(s_loadShown, line);
+        uint8_t endCol = display.col();
   { uint8_t __ux = endCol; uint8_t __uy = display.row(); display.setFont(defaultFont); display.setCursor(__ux, __uy + 1); display.print((const __FlashStringHelper *) l_a); display.setFont(stdNumb); }
-      } else {
-        display.setCursor(55, 4);
-        char d[5]; uint16_t W = m365_info.pwh; if (W > 9999) W = 9999; uint8_t len = 0;
-        if (W >= 1000) { d[len++] = '0' + (W / 1000) % 10; }
-        if (W >= 100)  { d[len++] = '0' + (W / 100) % 10; }
-        if (W >= 10)   { d[len++] = '0' + (W / 10) % 10; }
-        d[len++] = '0' + (W % 10); d[len] = 0;
-  const uint8_t FIELD = 6; for (uint8_t k = 0; k < FIELD - len; k++) display.print(' ');
-  display.print(d); uint8_t endCol = display.col(); { uint8_t __ux = endCol; uint8_t __uy = display.row(); display.setFont(defaultFont); display.setCursor(__ux, __uy + 1); display.print((const __FlashStringHelper *) l_w); display.setFont(stdNumb); }
+      }
+      } else if (uiFieldDirty(UIF_LOAD, 0x80000000UL | m365_info.pwh)) {
+        uint16_t W = m365_info.pwh; if (W > 9999) W = 9999;
+        LineBuf line; line.num(W, FMT_WATTS);
+        blitText(BLIT_STD, 55, 4, line.c_str(), 1, shown && (shownKey & 0x80000000UL) ? s_loadShown : nullptr);
+        remember(s_loadShown, line);
+  uint8_t endCol = display.col(); { uint8_t __ux = endCol; uint8_t __uy = display.row(); display.setFont(defaultFont); display.setCursor(__ux, __uy + 1); display.print((const __FlashStringHelper *) l_w); display.setFont(stdNumb); }
       }
     }
   showBatt(S25C31.remainPercent, cur_cA_raw < 0);
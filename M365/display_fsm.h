@@ -4,4 +4,9 @@
 // Main display state machine
 void displayFSM();
 
+// Layout of screen id (displayClear() IDs) for partial clears; false if the screen
+// has none and needs a full clear
+struct UiLayout;
+bool screenLayout(uint8_t id, UiLayout& l);
+
 #endif // DISPLAY_FSM_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "frame_sched.h"
+#include "idle_mode.h"
+#include "ui_cache.h"
+
+static uint32_t s_lastFrame = 0;
+static uint8_t s_lastInput = 0xFF;
+static FRAME_STATS_t s_stats = {0, 0, 0};
+static uint32_t s_winStart = 0, s_winSum = 0, s_winMax = 0;
+static uint8_t s_winCount = 0;
+static uint32_t s_drawUs = 0;     // smoothed displayFSM() time
+
+// Target interval for screen id (displayClear() IDs)
+static uint16_t screenPeriodMs(uint8_t id) {
+  switch (id) {
+    case 5: return CFG_FRAME_MS_RIDE;           // big speed/current
+    case 0: case 4: return CFG_FRAME_MS_MAIN;   // main screen, battery warning
+    default: return CFG_FRAME_MS_SLOW;          // menus, odometer, stats, info
+  }
+}
+
+// Throttle/brake quantised with the display's own thresholds
+static uint8_t inputState() {
+  uint8_t b = (S20C00HZ65.brake > 60) ? 2 : (S20C00HZ65.brake < 50) ? 0 : 1;
+  uint8_t t = (S20C00HZ65.throttle > 150) ? 2 : (S20C00HZ65.throttle < 50) ? 0 : 1;
+  return (uint8_t)((b << 2) | t);
+}
+
+bool frameDue(uint32_t gapUs) {
+  uint8_t in = inputState();
+  uint16_t period = idleActive() ? CFG_IDLE_FRAME_MS : screenPeriodMs(uiScreenCurrent());
+  uint32_t since = millis() - s_lastFrame;
+  if (in == s_lastInput && since < period) return false;
+  // Waiting for a gap that fits is best effort: the largest gap the bus can offer may
+  // be shorter than one slow frame (e.g. a full clear at 100 kHz), and s_drawUs only
+  // learns from frames that are drawn. After twice the period the frame goes anyway.
+  if (s_drawUs > gapUs && since < 2UL * period) return false;
+  s_lastInput = in;
+  return true;
+}
+
+void frameDone(uint32_t t0, uint32_t t1) {
+  uint32_t now = millis();
+  uint32_t cost = micros() - t0;
+  s_drawUs = (s_drawUs * 3 + (t1 - t0)) / 4;
+  s_lastFrame = now;
+  s_winSum += cost;
+  if (cost > s_winMax) s_winMax = cost;
+  if (s_winCount < 255) s_winCount++;
+  if ((now - s_winStart) >= 1000) {
+    s_stats.fps = s_winCount;
+    s_stats.avgUs = s_winSum / s_winCount;
+    s_stats.maxUs = s_winMax;
+    s_winStart = now; s_winSum = 0; s_winMax = 0; s_winCount = 0;
+  }
+}
+
+const FRAME_STATS_t& frameStats() { return s_stats; }
@@ -0,0 +1,27 @@
+#pragma once
+#include "defines.h"
+
+// Frame scheduler. Each screen has a target frame interval: short for the big
+// speed/current view while riding, long for menus and the info screens, and
+// CFG_IDLE_FRAME_MS while parked. A change of throttle/brake input draws a frame at
+// once, so menu navigation does not wait for the next slot.
+//
+//   if (frameDue(gap)) {
+//     uint32_t t0 = micros(); displayFSM(); uint32_t t1 = micros();
+//     display.flush(...); frameDone(t0, t1);
+//   }
+
+// True when a frame should be drawn now. gapUs is the time left before the next bus
+// window (busLoadGapUs()); a frame that would not fit, judging by recent draw times,
+// waits for the next gap, for at most twice the screen's period.
+bool frameDue(uint32_t gapUs = 0xFFFFFFFFUL);
+// Record the frame drawn from micros() t0 to t1 and flushed until now
+void frameDone(uint32_t t0, uint32_t t1);
+
+// Achieved rate over the last second
+struct FRAME_STATS_t {
+  uint8_t fps;        // frames drawn
+  uint32_t avgUs;     // mean draw + flush time (the part of the flush sent that pass)
+  uint32_t maxUs;     // worst draw + flush time
+};
+const FRAME_STATS_t& frameStats();
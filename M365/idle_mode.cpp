@@ -0,0 +1,61 @@
+#include "idle_mode.h"
+#include "ride_metrics.h"
+#if defined(ARDUINO_ARCH_AVR)
+  #include <avr/sleep.h>
+#endif
+
+// A bus that was quiet this long and then sends a frame counts as activity
+static const uint16_t BUS_SILENCE_MS = 1000;
+
+static bool s_idle = false;
+static uint32_t s_lastActive = 0;
+static uint32_t s_lastFrame = 0;
+static uint32_t s_lastPoll = 0;
+
+static void idleWake() {
+  s_lastActive = millis();
+  s_idle = false;
+}
+
+static bool telemetryActive() {
+  // Same 0.2 km/h stationary threshold as the display
+  if (rideMetrics().speedRaw > 200) return true;
+  if (abs(S25C31.current) > CFG_IDLE_CURRENT_CA) return true;
+  // Throttle/brake off their rest positions (same thresholds as menu input)
+  if (S20C00HZ65.throttle >= 50 || S20C00HZ65.brake >= 50) return true;
+  return false;
+}
+
+void idleTick() {
+  if (telemetryActive()) { idleWake(); return; }
+  // Hibernation keeps us off the bus anyway, so there is no reason to wait
+  if (!s_idle && (_Hibernate || (millis() - s_lastActive) >= CFG_IDLE_TIMEOUT_MS)) s_idle = true;
+}
+
+void idleOnFrame() {
+  uint32_t now = millis();
+  if (s_idle && (now - s_lastFrame) >= BUS_SILENCE_MS) idleWake();
+  s_lastFrame = now;
+}
+
+bool idleActive() { return s_idle; }
+
+bool idlePollDue() {
+  if (!s_idle) return true;
+  uint32_t now = millis();
+  if ((now - s_lastPoll) < CFG_IDLE_POLL_MS) return false;
+  s_lastPoll = now;
+  return true;
+}
+
+void idleSleep() {
+  if (!s_idle) return;
+#if defined(ARDUINO_ARCH_AVR)
+  // Idle sleep keeps timer0 and the UART running: the next 1 ms tick or RX byte resumes us
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_mode();
+#elif defined(ARDUINO_ARCH_ESP32)
+  // Yield to the idle task; the UART FIFO and driver buffer hold incoming bytes meanwhile
+  delay(CFG_IDLE_SLEEP_MS);
+#endif
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "defines.h"
+
+// Parked/idle detection. With no speed, current or throttle/brake input for
+// CFG_IDLE_TIMEOUT_MS the dashboard polls slowly, redraws rarely and sleeps between
+// loop passes. Any input, motion or bus traffic after a silence restores full rate.
+
+// Re-evaluate idle state from the latest telemetry; call once per loop pass
+void idleTick();
+
+// Hook from the RX path for every valid frame
+void idleOnFrame();
+
+bool idleActive();
+
+// Gate for the slow poll cadence; always true while not idle (the frame cadence is
+// in frame_sched)
+bool idlePollDue();
+
+// Sleep until the next interrupt/tick when idle; no-op otherwise
+void idleSleep();
@@ -67,6 +67,10 @@
   const char tempHdr[] PROGMEM = {"Temperatures"};
   const char tempBatt[] PROGMEM = {"Batt T1/T2:"};
   const char tempDrv[] PROGMEM = {"DRV temp:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Cyc:"};
+  const char devCharges[] PROGMEM = {"Chg:"};
+  const char devMade[] PROGMEM = {"Made: "};
  
   const char M365CfgScr1[] PROGMEM = {"Cruise control: "};
   const char M365CfgScr2[] PROGMEM = {"Update Cruise"};
@@ -143,6 +147,10 @@
   const char statsUminUmax[] PROGMEM = {"Umin/Umax:"};
   const char statsUmin[] PROGMEM = {"Umin:"};
   const char statsUmax[] PROGMEM = {"Umax:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Cic:"};
+  const char devCharges[] PROGMEM = {"Car:"};
+  const char devMade[] PROGMEM = {"Prod: "};
  
   const char M365CfgScr1[] PROGMEM = {"Cruise control: "};
   const char M365CfgScr2[] PROGMEM = {"Agg. Cruise"};
@@ -219,6 +227,10 @@
   const char statsUminUmax[] PROGMEM = {"Umin/Umax:"};
   const char statsUmin[] PROGMEM = {"Umin:"};
   const char statsUmax[] PROGMEM = {"Umax:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Cyc:"};
+  const char devCharges[] PROGMEM = {"Chg:"};
+  const char devMade[] PROGMEM = {"Fab: "};
 
   const char M365CfgScr1[] PROGMEM = {"Contrôle régulateur: "};
   const char M365CfgScr2[] PROGMEM = {"MAJ Régulateur"};
@@ -295,6 +307,10 @@
   const char statsUminUmax[] PROGMEM = {"Umin/Umax:"};
   const char statsUmin[] PROGMEM = {"Umin:"};
   const char statsUmax[] PROGMEM = {"Umax:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Cic:"};
+  const char devCharges[] PROGMEM = {"Car:"};
+  const char devMade[] PROGMEM = {"Fab: "};
 
   const char M365CfgScr1[] PROGMEM = {"Control crucero: "};
   const char M365CfgScr2[] PROGMEM = {"Actualizar crucero"};
@@ -371,6 +387,10 @@
   const char statsUminUmax[] PROGMEM = {"Umin/Umax:"};
   const char statsUmin[] PROGMEM = {"Umin:"};
   const char statsUmax[] PROGMEM = {"Umax:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Cyk:"};
+  const char devCharges[] PROGMEM = {"Nab:"};
+  const char devMade[] PROGMEM = {"Vyr: "};
 
   const char M365CfgScr1[] PROGMEM = {"Tempomat:        "};
   const char M365CfgScr2[] PROGMEM = {"Uloz nast. tempomatu"};
@@ -450,6 +470,10 @@
   const char statsUminUmax[] PROGMEM = {"Umin/Umax:"};
   const char statsUmin[] PROGMEM = {"Umin:"};
   const char statsUmax[] PROGMEM = {"Umax:"};
+  // Device info screen
+  const char devCycles[] PROGMEM = {"Zyk:"};
+  const char devCharges[] PROGMEM = {"Lad:"};
+  const char devMade[] PROGMEM = {"Herg: "};
  
   const char M365CfgScr1[] PROGMEM = {"Cruise control: "};
   const char M365CfgScr2[] PROGMEM = {"Update Cruise"};
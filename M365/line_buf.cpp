@@ -0,0 +1,47 @@
+#include "line_buf.h"
+
+LineBuf& LineBuf::ch(char c) {
+  if (m_len < CAP - 1) { m_buf[m_len++] = c; m_buf[m_len] = 0; }
+  return *this;
+}
+
+LineBuf& LineBuf::str(const char* s) {
+  while (*s) ch(*s++);
+  return *this;
+}
+
+LineBuf& LineBuf::pstr(const char* p) {
+  for (char c; (c = (char)pgm_read_byte(p)) != 0; p++) ch(c);
+  return *this;
+}
+
+LineBuf& LineBuf::padTo(uint8_t len) {
+  while (m_len < len && m_len < CAP - 1) ch(' ');
+  return *this;
+}
+
+LineBuf& LineBuf::num(int32_t v, const NumFmt& f) {
+  // Digits, least significant first
+  char d[12];
+  uint8_t n = 0;
+  bool neg = v < 0;
+  uint32_t u = neg ? (uint32_t)(-(v + 1)) + 1 : (uint32_t)v;
+  do { d[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+  // At least one integer digit and all the decimals
+  while (n < f.decimals + 1) d[n++] = '0';
+
+  uint8_t intLen = (uint8_t)(n - f.decimals + neg);
+  if (f.pad == '0') {
+    if (neg) ch('-');
+    for (uint8_t i = intLen; i < f.width; i++) ch('0');
+  } else {
+    for (uint8_t i = intLen; i < f.width; i++) ch(' ');
+    if (neg) ch('-');
+  }
+  while (n > f.decimals) ch(d[--n]);
+  if (f.decimals) {
+    ch('.');
+    while (n) ch(d[--n]);
+  }
+  return *this;
+}
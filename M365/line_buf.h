@@ -0,0 +1,57 @@
+#pragma once
+#include "defines.h"
+
+// Fixed-width text for the display. A row (or one font's part of it) is built in a
+// LineBuf and sent with a single display.print(), instead of a print() per padding
+// character, digit and separator. Number layouts are compile-time NumFmt constants,
+// so every screen pads the same quantity the same way:
+//
+//   LineBuf line;
+//   line.num(S25C31.voltage, FMT_FIX2_2).pstr(l_v);   // "41.23V", " 9.87V"
+//   display.print(line.c_str());
+
+// Number field layout. The value is an integer scaled by 10^decimals (centivolts for
+// decimals 2). Values wider than the field are printed in full.
+struct NumFmt {
+  uint8_t width;      // minimum characters before the point, sign included
+  uint8_t decimals;   // digits after the point, zero-padded
+  char pad;           // left padding: ' ' or '0'
+};
+
+// Layouts shared by the screens: FMT_INTn pads an integer to n characters,
+// FMT_FIXn_d has n characters before the point and d after it.
+static constexpr NumFmt FMT_INT1 = {1, 0, ' '};    // plain integer
+static constexpr NumFmt FMT_INT2 = {2, 0, ' '};    // " 7", "42"
+static constexpr NumFmt FMT_INT3 = {3, 0, ' '};    // "  7", "142"
+static constexpr NumFmt FMT_INT4 = {4, 0, ' '};    // "   7", "4242"
+static constexpr NumFmt FMT_ZERO2 = {2, 0, '0'};   // "07": minutes, seconds
+static constexpr NumFmt FMT_FIX1_3 = {1, 3, ' '};  // "4.012": cell volts
+static constexpr NumFmt FMT_FIX2_1 = {2, 1, ' '};  // " 7.5"
+static constexpr NumFmt FMT_FIX2_2 = {2, 2, ' '};  // " 9.87", "41.23"
+static constexpr NumFmt FMT_FIX3_1 = {3, 1, ' '};  // "  7.5", "123.4"
+static constexpr NumFmt FMT_FIX3_2 = {3, 2, ' '};  // "  7.50", "123.45"
+static constexpr NumFmt FMT_FIX4_2 = {4, 2, ' '};  // "   7.50", "1234.56"
+
+class LineBuf {
+public:
+  LineBuf() { clear(); }
+
+  LineBuf& clear() { m_len = 0; m_buf[0] = 0; return *this; }
+  LineBuf& num(int32_t v, const NumFmt& f);
+  LineBuf& ch(char c);
+  // RAM string
+  LineBuf& str(const char* s);
+  // PROGMEM string (language.h)
+  LineBuf& pstr(const char* p);
+  LineBuf& str(const __FlashStringHelper* s) { return pstr((const char*)s); }
+  // Spaces up to len characters, e.g. to overwrite the tail of a longer old value
+  LineBuf& padTo(uint8_t len);
+
+  const char* c_str() const { return m_buf; }
+  uint8_t length() const { return m_len; }
+
+private:
+  static const uint8_t CAP = 24;   // 21 columns of the 5x7 font and some slack
+  char m_buf[CAP];
+  uint8_t m_len;
+};
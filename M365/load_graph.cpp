@@ -0,0 +1,102 @@
+#include "load_graph.h"
+#include "ui_cache.h"
+#include "line_buf.h"
+#include "ride_metrics.h"
+
+static const uint8_t GRAPH_COLS = 128;
+static const uint32_t COLUMN_MS = CFG_GRAPH_SECONDS * 1000UL / GRAPH_COLS;
+// The plot fills pages 1..7 below the value row
+static const uint8_t PLOT_PAGE = 1;
+static const uint8_t PLOT_H = 56;
+
+static uint8_t s_samples[GRAPH_COLS];   // load per column, 255 = full scale
+static uint8_t s_head = 0;              // slot of the column being collected (the gap)
+static uint8_t s_peak = 0;              // highest load seen in that column so far
+static uint32_t s_colStart = 0;
+static bool s_power = CFG_SHOW_POWER_DEFAULT;   // unit the ring was filled in
+static uint8_t s_drawnHead = 0;         // gap column on the panel
+static bool s_redraw = true;            // ring was reset: the whole plot is stale
+
+// Present load scaled to the plot; regen is not load and counts as zero
+static uint8_t loadLevel() {
+  const RIDE_METRICS_t& m = rideMetrics();
+  if (m.current_cA <= 0) return 0;
+  uint32_t v;
+  if (s_power) v = (uint32_t)m.pwh * 255UL / CFG_GRAPH_FULL_W;
+  else v = (uint32_t)m.current_cA * 255UL / (CFG_GRAPH_FULL_A * 100UL);
+  return v > 255 ? 255 : (uint8_t)v;
+}
+
+void graphTick() {
+  if (showPower != s_power) {
+    // The samples are in the other unit
+    s_power = showPower;
+    memset(s_samples, 0, sizeof(s_samples));
+    s_peak = 0;
+    s_redraw = true;
+  }
+  // Highest load of the slice, so short peaks between columns still show
+  uint8_t v = loadLevel();
+  if (v > s_peak) s_peak = v;
+
+  uint32_t now = millis();
+  if (now - s_colStart < COLUMN_MS) return;
+  // After a stall the next slice starts now rather than catching up
+  s_colStart = (now - s_colStart >= 2 * COLUMN_MS) ? now : s_colStart + COLUMN_MS;
+  s_samples[s_head] = s_peak;
+  s_head = (uint8_t)((s_head + 1) % GRAPH_COLS);
+  s_peak = 0;
+}
+
+// Column byte of a bar of level on page: filled from the bottom of the plot, with a
+// baseline on the lowest pixel row
+static uint8_t columnByte(uint8_t level, uint8_t page) {
+  uint8_t h = (uint8_t)((uint16_t)level * PLOT_H / 255);
+  int8_t blank = (int8_t)(PLOT_H - h) - (int8_t)((page - PLOT_PAGE) * 8);
+  uint8_t b = (blank <= 0) ? 0xFF : (blank >= 8) ? 0x00 : (uint8_t)(0xFF << blank);
+  if (page == 7) b |= 0x80;
+  return b;
+}
+
+// Columns from up to the write pointer (wrapping past the right edge), then the blank
+// gap at the write pointer; one data run per page and piece
+static void drawColumns(uint8_t from) {
+  for (uint8_t page = PLOT_PAGE; page < 8; page++) {
+    uint8_t x = from;
+    display.setCursor(x, page);
+    while (x != s_head) {
+      display.ssd1306WriteRamBuf(columnByte(s_samples[x], page));
+      x = (uint8_t)((x + 1) % GRAPH_COLS);
+      if (x == 0) display.setCursor(0, page);
+    }
+    display.ssd1306WriteRamBuf(0);
+  }
+  s_drawnHead = s_head;
+}
+
+void fsLoadGraph() {
+  display.set1X(); display.setFont(defaultFont);
+  if (displayClear(16, s_redraw)) {
+    // Full scale at the top right, then every column once
+    LineBuf line;
+    if (s_power) line.num(CFG_GRAPH_FULL_W, FMT_INT1).pstr(l_w);
+    else line.num(CFG_GRAPH_FULL_A, FMT_INT1).pstr(l_a);
+    display.setCursor(display.displayWidth() - display.strWidth(line.c_str()), 0);
+    display.print(line.c_str());
+    drawColumns((uint8_t)((s_head + 1) % GRAPH_COLS));
+    s_redraw = false;
+  } else if (s_drawnHead != s_head) {
+    drawColumns(s_drawnHead);
+  }
+
+  // Present value at the top left, signed so regen shows
+  const RIDE_METRICS_t& m = rideMetrics();
+  int32_t v = !s_power ? m.current_cA : (m.current_cA < 0) ? -(int32_t)m.pwh : (int32_t)m.pwh;
+  if (!uiFieldDirty(UIF_GRAPH, ((uint32_t)s_power << 31) | ((uint32_t)v & 0x7FFFFFFFUL))) return;
+  LineBuf line;
+  if (s_power) line.num(v, FMT_INT4).pstr(l_w);
+  else line.num(v, FMT_FIX2_2).pstr(l_a);
+  line.padTo(8);
+  display.setCursor(0, 0);
+  display.print(line.c_str());
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "defines.h"
+
+// Load graph screen: power, or current when the main screen shows amps, over the last
+// CFG_GRAPH_SECONDS. Samples are kept in a RAM ring of one byte per column, and ring
+// slot i is always drawn at column i: the plot is a sweep with a blank column at the
+// write pointer, so each new sample sends its own column and the blank one ahead of
+// it instead of the whole plot.
+
+// Fold the present load into the newest column and close it when its time slice is
+// over; call every loop pass
+void graphTick();
+
+// Draw the load graph screen
+void fsLoadGraph();
@@ -0,0 +1,183 @@
+// M365 bus protocol: frame constants, telemetry layouts, encoder and streaming decoder.
+// Header-only and allocation-free, no Arduino dependencies: the firmware and the host
+// tools (tools/m365cap2csv.cpp) build the same code.
+//
+// Frame on the wire (all multi-byte fields little-endian):
+//   55 AA | len | addr | hz | cmd | payload[len-2] | csL csH
+// len counts hz, cmd and payload; the checksum is 0xFFFF minus the byte sum of
+// len..payload.
+#ifndef M365_PROTO_H
+#define M365_PROTO_H
+
+#include <stdint.h>
+#include <string.h>
+
+namespace m365proto {
+
+static const uint8_t SYNC0 = 0x55;
+static const uint8_t SYNC1 = 0xAA;
+
+// Sync + len/addr/hz/cmd + checksum
+static const uint8_t FRAME_OVERHEAD = 8;
+
+// Addresses
+static const uint8_t ADDR_BLE_ESC = 0x20; // BLE module -> ESC (control frames, our ESC reads/writes)
+static const uint8_t ADDR_BLE_BMS = 0x21; // BLE module status frames
+static const uint8_t ADDR_TO_BMS  = 0x22; // our BMS reads
+static const uint8_t ADDR_ESC     = 0x23; // ESC answers
+static const uint8_t ADDR_BMS     = 0x25; // BMS answers
+
+// hz byte: operation for requests, frame kind for control frames
+static const uint8_t OP_READ      = 0x01; // plain register read (BMS)
+static const uint8_t OP_WRITE     = 0x03; // register write (ESC)
+static const uint8_t OP_READ_CTL  = 0x61; // register read carrying throttle/brake (ESC)
+static const uint8_t HZ_STATUS    = 0x64;
+static const uint8_t HZ_CONTROL   = 0x65; // BLE control frame; our TX slot follows it
+
+// ESC write registers
+static const uint8_t REG_KERS     = 0x7B;
+static const uint8_t REG_CRUISE   = 0x7C;
+static const uint8_t REG_TAILIGHT = 0x7D;
+static const uint8_t REG_INFO     = 0x10; // serial/firmware (ESC and BMS)
+
+struct __attribute__((packed)) FrameHeader { uint8_t len, addr, hz, cmd; };
+
+// Telemetry layouts (payload only)
+struct __attribute__((packed)) A20C00HZ65 { uint8_t hz1, throttle, brake, hz2, hz3; };
+struct __attribute__((packed)) A21C00HZ64 { uint8_t state, ledBatt, headLamp, beepAction; };
+struct __attribute__((packed)) A25C31 { uint16_t remainCapacity; uint8_t remainPercent, u4; int16_t current, voltage; uint8_t temp1, temp2; };
+struct __attribute__((packed)) A25C40 { int16_t c1,c2,c3,c4,c5,c6,c7,c8,c9,c10,c11,c12,c13,c14,c15; };
+struct __attribute__((packed)) A25C10 { char serial[14]; uint16_t fw; uint16_t capacity; uint8_t u1[4]; uint16_t cycles; uint16_t charges; uint8_t u2[6]; uint16_t prodDate; };
+struct __attribute__((packed)) A23C3E { int16_t i1; };
+struct __attribute__((packed)) A23CB0 { uint8_t u1[10]; int16_t speed; uint16_t averageSpeed; uint32_t mileageTotal; uint16_t mileageCurrent; uint16_t elapsedPowerOnTime; int16_t mainframeTemp; uint8_t u2[8]; };
+struct __attribute__((packed)) A23C23 { uint8_t u1,u2,u3,u4; uint16_t remainMileage; };
+struct __attribute__((packed)) A23C3A { uint16_t powerOnTime, ridingTime; };
+struct __attribute__((packed)) A23C10 { char serial[14]; char pin[6]; uint16_t fw; };
+
+static_assert(sizeof(FrameHeader) == 4, "frame header");
+static_assert(sizeof(A25C31) == 10 && sizeof(A25C40) == 30 && sizeof(A25C10) == 34, "BMS layouts");
+static_assert(sizeof(A23CB0) == 32 && sizeof(A23C23) == 6 && sizeof(A23C3A) == 4 && sizeof(A23C10) == 22, "ESC layouts");
+
+// Payload size of the telemetry layout a frame carries, 0 if none. Addr 0x20 cmd 0x00
+// is the throttle/brake layout only for hz 0x65, as in comms.cpp.
+inline uint8_t layoutSize(const FrameHeader& h) {
+  switch ((h.addr << 8) | h.cmd) {
+    case (ADDR_BLE_ESC << 8) | 0x00: return h.hz == HZ_CONTROL ? sizeof(A20C00HZ65) : 0;
+    case (ADDR_BMS << 8) | 0x31: return sizeof(A25C31);
+    case (ADDR_BMS << 8) | 0x40: return sizeof(A25C40);
+    case (ADDR_ESC << 8) | 0xB0: return sizeof(A23CB0);
+    case (ADDR_ESC << 8) | 0x3E: return sizeof(A23C3E);
+    case (ADDR_ESC << 8) | 0x23: return sizeof(A23C23);
+    case (ADDR_ESC << 8) | 0x3A: return sizeof(A23C3A);
+  }
+  return 0;
+}
+
+inline uint16_t checksum(const uint8_t* data, uint8_t len) {
+  uint16_t cs = 0xFFFF;
+  for (uint8_t i = len; i > 0; i--) cs -= *data++;
+  return cs;
+}
+
+// ---------------------------------------------------------------------------------
+// Encoder. Each function writes a complete frame (sync to checksum) into out, which
+// must hold FRAME_OVERHEAD + payload bytes, and returns its length.
+// ---------------------------------------------------------------------------------
+inline uint8_t encodeFrame(uint8_t* out, uint8_t addr, uint8_t hz, uint8_t cmd, const uint8_t* payload, uint8_t n) {
+  out[0] = SYNC0; out[1] = SYNC1;
+  out[2] = (uint8_t)(n + 2); out[3] = addr; out[4] = hz; out[5] = cmd;
+  if (n) memcpy(out + 6, payload, n);
+  uint16_t cs = checksum(out + 2, (uint8_t)(n + 4));
+  out[6 + n] = (uint8_t)cs; out[7 + n] = (uint8_t)(cs >> 8);
+  return (uint8_t)(n + FRAME_OVERHEAD);
+}
+
+// Read n bytes from BMS register reg
+inline uint8_t encodeBmsRead(uint8_t* out, uint8_t reg, uint8_t n) {
+  return encodeFrame(out, ADDR_TO_BMS, OP_READ, reg, &n, 1);
+}
+
+// Read n bytes from ESC register reg; the ESC expects the current throttle/brake
+inline uint8_t encodeEscRead(uint8_t* out, uint8_t reg, uint8_t n, uint8_t throttle, uint8_t brake) {
+  const uint8_t p[4] = { n, 0x02, throttle, brake };
+  return encodeFrame(out, ADDR_BLE_ESC, OP_READ_CTL, reg, p, sizeof(p));
+}
+
+// Write a 16-bit value to ESC register reg
+inline uint8_t encodeEscWrite(uint8_t* out, uint8_t reg, int16_t value) {
+  const uint8_t p[2] = { (uint8_t)value, (uint8_t)((uint16_t)value >> 8) };
+  return encodeFrame(out, ADDR_BLE_ESC, OP_WRITE, reg, p, sizeof(p));
+}
+
+// ---------------------------------------------------------------------------------
+// Streaming decoder. Feed bytes one at a time with push(); when it returns RX_FRAME,
+// header()/payload()/payloadLen() describe the frame until the next push(). N is the
+// largest payload accepted; longer frames are dropped and the decoder resyncs.
+// ---------------------------------------------------------------------------------
+enum RxResult : uint8_t { RX_NONE, RX_FRAME, RX_BAD_CHECKSUM, RX_OVERSIZE };
+
+template <uint8_t N>
+class Decoder {
+public:
+  Decoder() { reset(); }
+
+  void reset() { m_state = S_SYNC0; }
+
+  // True while a frame is partially received (use to apply an inter-byte timeout)
+  bool busy() const { return m_state != S_SYNC0; }
+
+  RxResult push(uint8_t b) {
+    switch (m_state) {
+      case S_SYNC0:
+        if (b == SYNC0) m_state = S_SYNC1;
+        return RX_NONE;
+      case S_SYNC1:
+        if (b == SYNC1) { m_state = S_HEADER; m_pos = 0; m_cs = 0xFFFF; }
+        else if (b != SYNC0) m_state = S_SYNC0;
+        return RX_NONE;
+      case S_HEADER:
+        ((uint8_t*)&m_hdr)[m_pos++] = b;
+        m_cs -= b;
+        if (m_pos == 1 && (b < 2 || (uint8_t)(b - 2) > N)) {
+          m_state = (b == SYNC0) ? S_SYNC1 : S_SYNC0;
+          return RX_OVERSIZE;
+        }
+        if (m_pos == sizeof(m_hdr)) { m_pos = 0; m_state = (m_hdr.len == 2) ? S_CS0 : S_BODY; }
+        return RX_NONE;
+      case S_BODY:
+        m_buf[m_pos++] = b;
+        m_cs -= b;
+        if (m_pos == (uint8_t)(m_hdr.len - 2)) m_state = S_CS0;
+        return RX_NONE;
+      case S_CS0:
+        m_csLo = b;
+        m_state = S_CS1;
+        return RX_NONE;
+      default:
+        m_state = S_SYNC0;
+        return ((uint16_t)((b << 8) | m_csLo) == m_cs) ? RX_FRAME : RX_BAD_CHECKSUM;
+    }
+  }
+
+  const FrameHeader& header() const { return m_hdr; }
+  const uint8_t* payload() const { return m_buf; }
+  uint8_t payloadLen() const { return (uint8_t)(m_hdr.len - 2); }
+
+  // Copy the payload into a telemetry layout if the size matches
+  template <typename T> bool payloadAs(T& out) const {
+    if (payloadLen() != sizeof(T)) return false;
+    memcpy((void*)&out, m_buf, sizeof(T));
+    return true;
+  }
+
+private:
+  enum : uint8_t { S_SYNC0, S_SYNC1, S_HEADER, S_BODY, S_CS0, S_CS1 };
+  FrameHeader m_hdr;
+  uint8_t m_buf[N];
+  uint8_t m_state, m_pos, m_csLo;
+  uint16_t m_cs;
+};
+
+} // namespace m365proto
+
+#endif // M365_PROTO_H
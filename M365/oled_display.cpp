@@ -0,0 +1,406 @@
+#include "defines.h"
+
+// Dirty columns closer than this are sent as one run; a cursor move costs about as much
+static const uint8_t RUN_GAP = 3;
+
+#if defined(DISPLAY_I2C)
+#if defined(OLED_TWI_ASYNC)
+static const uint8_t TX_MAX = TWI_FRAME_MAX;
+// Queue bytes a flush piece can take besides its cursor commands and data: headers of
+// up to two new frames for the commands and two for the data, and two control bytes
+static const uint8_t TWI_SLACK = 8;
+static inline void txBegin(uint8_t addr) { twiFrameBegin(addr); }
+static inline void txWrite(uint8_t b) { twiFrameWrite(b); }
+// Failures are reported later by the interrupt, see takeBusStats()
+static inline bool txEnd() { twiFrameEnd(); return true; }
+#else
+// Wire TX buffer: 32 bytes on AVR, 128 on ESP32
+#if defined(I2C_BUFFER_LENGTH)
+static const uint8_t TX_MAX = I2C_BUFFER_LENGTH;
+#elif defined(BUFFER_LENGTH)
+static const uint8_t TX_MAX = BUFFER_LENGTH;
+#else
+static const uint8_t TX_MAX = 32;
+#endif
+static inline void txBegin(uint8_t addr) { Wire.beginTransmission(addr); }
+static inline void txWrite(uint8_t b) { Wire.write(b); }
+static inline bool txEnd() { return Wire.endTransmission() == 0; }
+#endif
+
+// SSD1306 I2C control bytes
+static const uint8_t CTRL_CMD_PAIR = 0x80;   // Co=1: one command byte follows, then another control byte
+static const uint8_t CTRL_DATA_STREAM = 0x40; // Co=0, D/C#=1: data until STOP
+
+void OledDisplay::busWrite(uint8_t b, uint8_t mode) {
+  if (mode == SSD1306_MODE_CMD) {
+    // Commands cannot follow a data stream in the same transaction
+    if (m_txData || m_txLen + 2 > TX_MAX) busEnd();
+    if (m_txLen == 0) txBegin(m_i2cAddr);
+    txWrite(CTRL_CMD_PAIR);
+    txWrite(b);
+    m_txLen += 2;
+    return;
+  }
+  if (m_txLen + (m_txData ? 1 : 2) > TX_MAX) busEnd();
+  if (m_txLen == 0) txBegin(m_i2cAddr);
+  if (!m_txData) { txWrite(CTRL_DATA_STREAM); m_txLen++; m_txData = true; }
+  txWrite(b);
+  m_txLen++;
+}
+
+void OledDisplay::busEnd() {
+  if (m_txLen == 0) return;
+  if (txEnd()) {
+    m_failStreak = 0;
+  } else {
+    m_txFailed++;
+    if (m_failStreak < 255) m_failStreak++;
+  }
+  m_txCount++;
+  m_txLen = 0;
+  m_txData = false;
+}
+
+void OledDisplay::takeBusStats(uint16_t& sent, uint16_t& failed) {
+#if defined(OLED_TWI_ASYNC)
+  m_txFailed += twiTakeErrors();
+#endif
+  sent = m_txCount;
+  failed = m_txFailed;
+  m_txCount = m_txFailed = 0;
+}
+
+uint8_t OledDisplay::failStreak() {
+#if defined(OLED_TWI_ASYNC)
+  return twiFailStreak();
+#else
+  return m_failStreak;
+#endif
+}
+#elif defined(OLED_SPI_DMA)
+// D/C is per frame: a frame holds only commands or only data
+void OledDisplay::busWrite(uint8_t b, uint8_t mode) {
+  bool data = (mode != SSD1306_MODE_CMD);
+  if (m_txLen && (m_txData != data || m_txLen >= SPI_FRAME_MAX)) busEnd();
+  if (m_txLen == 0) { spiFrameBegin(data); m_txData = data; }
+  spiFrameWrite(b);
+  m_txLen++;
+}
+
+void OledDisplay::busEnd() {
+  if (m_txLen == 0) return;
+  spiFrameEnd();
+  m_txLen = 0;
+}
+#else
+void OledDisplay::busWrite(uint8_t b, uint8_t mode) { OledBase::writeDisplay(b, mode); }
+void OledDisplay::busEnd() {}
+#endif
+
+// Bus bytes of one cursor command (a command pair on I2C) and of a full cursor move
+static const uint8_t CMD_BYTES = 2;
+static const uint8_t CURSOR_BYTES = 3 * CMD_BYTES;
+
+void OledDisplay::sendCursor(uint8_t page, uint8_t col) {
+  if (page == m_hwPage && col == m_hwCol) return;
+  // Page addressing, the only mode the SH1106 has: page, low and high column nibble are
+  // separate commands, so only the ones that change are sent. The column offset (2 on
+  // the SH1106's 132-column RAM) is applied here.
+  uint8_t c = col + m_colOffset;
+  uint8_t hc = m_hwCol + m_colOffset;
+  bool known = (m_hwCol != 0xFF);
+  if (page != m_hwPage) {
+    busWrite(SSD1306_SETSTARTPAGE | page, SSD1306_MODE_CMD);
+    m_sent += CMD_BYTES;
+  }
+  if (!known || (c & 0x0F) != (hc & 0x0F)) {
+    busWrite(SSD1306_SETLOWCOLUMN | (c & 0x0F), SSD1306_MODE_CMD);
+    m_sent += CMD_BYTES;
+  }
+  if (!known || (c >> 4) != (hc >> 4)) {
+    busWrite(SSD1306_SETHIGHCOLUMN | (c >> 4), SSD1306_MODE_CMD);
+    m_sent += CMD_BYTES;
+  }
+  m_hwPage = page; m_hwCol = col;
+}
+
+void OledDisplay::sendData(const uint8_t* p, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) busWrite(p[i], SSD1306_MODE_RAM_BUF);
+  m_hwCol += n;
+  // Past the last column the SSD1306 wraps and the SH1106 does not
+  if (m_hwCol >= 128) m_hwCol = 0xFF;
+  m_sent += n;
+}
+
+uint8_t OledDisplay::room() {
+  if (m_budget == NO_BUDGET) return 255;
+  uint32_t used = micros() - m_flushStart;
+  if (used >= m_budget) return 0;
+  uint32_t n = (m_budget - used) / m_usPerByte;
+#if defined(OLED_TWI_ASYNC)
+  uint8_t q = twiRoom();
+  q = (q > TWI_SLACK) ? q - TWI_SLACK : 0;
+  if (n > q) n = q;
+#endif
+  return n > 255 ? 255 : (uint8_t)n;
+}
+
+bool OledDisplay::flush(uint32_t budgetUs) {
+  m_flushStart = micros();
+  m_budget = budgetUs;
+  m_sent = 0;
+  bool done = shadowFlush();
+  busEnd();
+  // Learn the transfer cost from flushes large enough to measure
+  if (m_sent >= 32) {
+    uint32_t us = (micros() - m_flushStart) / m_sent;
+    if (us > 1000) us = 1000;
+    m_usPerByte = (uint16_t)((m_usPerByte * 3UL + us + 3) / 4);
+  }
+  m_budget = NO_BUDGET;
+  return done;
+}
+
+void OledDisplay::writeDisplay(uint8_t b, uint8_t mode) {
+  if (m_init) {
+    if (mode == SSD1306_MODE_CMD && m_initLeft) { m_initLeft--; busWrite(b, mode); }
+    return;
+  }
+  if (m_direct) { busWrite(b, mode); return; }
+  if (mode == SSD1306_MODE_CMD) {
+    // Cursor moves are already reflected in m_col/m_row; flush() positions itself
+    if (!m_cmdArg && (b < 0x20 || (b & 0xF8) == SSD1306_SETSTARTPAGE)) return;
+    m_cmdArg = !m_cmdArg && (b == SSD1306_SETCONTRAST);
+#if CFG_OLED_SHADOW == 2
+    stageFlush();
+#endif
+    busWrite(b, mode);
+    return;
+  }
+  uint8_t page = (m_row + m_pageOffset) & 7;
+#if CFG_OLED_SHADOW == 1
+  if (m_shadow[page][m_col] != b) {
+    m_shadow[page][m_col] = b;
+    m_dirty[page][m_col >> 3] |= (uint8_t)(1 << (m_col & 7));
+  }
+#elif CFG_OLED_SHADOW == 2
+  stagePush(page, m_col, b);
+#else
+  (void)page;
+#endif
+}
+
+#if CFG_OLED_SHADOW == 1
+
+void OledDisplay::shadowReset() {
+  // Panel content unknown after begin(): every column is sent blank
+  memset(m_shadow, 0, sizeof(m_shadow));
+  memset(m_dirty, 0xFF, sizeof(m_dirty));
+  m_hwPage = m_hwCol = 0xFF;
+  m_cmdArg = false;
+}
+
+// Runs are sent in pieces of at most this many columns so a budget is checked often
+static const uint8_t FLUSH_CHUNK = 16;
+
+bool OledDisplay::shadowFlush() {
+  for (uint8_t page = 0; page < 8; page++) {
+    uint8_t* dirty = m_dirty[page];
+    uint8_t col = 0;
+    while (col < 128) {
+      if (dirty[col >> 3] == 0 && (col & 7) == 0) { col += 8; continue; }
+      if (!(dirty[col >> 3] & (1 << (col & 7)))) { col++; continue; }
+      // Run from the first dirty column until RUN_GAP clean columns in a row
+      uint8_t start = col, end = col, c = col + 1;
+      while (c < 128 && (uint8_t)(c - end) <= RUN_GAP) {
+        if (dirty[c >> 3] & (1 << (c & 7))) end = c;
+        c++;
+      }
+      while (start <= end) {
+        uint8_t n = end - start + 1;
+        if (n > FLUSH_CHUNK) n = FLUSH_CHUNK;
+        // A short budget still moves the flush along, one smaller piece at a time
+        uint8_t r = room();
+        if (r <= CURSOR_BYTES) return false;
+        if (n > r - CURSOR_BYTES) n = r - CURSOR_BYTES;
+        sendCursor(page, start);
+        sendData(&m_shadow[page][start], n);
+        for (uint8_t k = start; k < start + n; k++) dirty[k >> 3] &= ~(1 << (k & 7));
+        start += n;
+      }
+      col = end + 1;
+    }
+  }
+  return true;
+}
+
+#elif CFG_OLED_SHADOW == 2
+
+static uint16_t segHash(const uint8_t* p) {
+  // CRC-16/CCITT: any change confined to 16 bits is always detected
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc ^= (uint16_t)p[i] << 8;
+    for (uint8_t k = 0; k < 8; k++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+  }
+  return crc;
+}
+
+void OledDisplay::shadowReset() {
+  // Panel content unknown after begin(): every segment is sent blank
+  for (uint8_t p = 0; p < 8; p++) {
+    m_segValid[p] = 0;
+    m_segBlank[p] = 0xFFFF;
+  }
+  for (uint8_t i = 0; i < STAGES; i++) m_stage[i].mask = 0;
+  for (uint8_t i = 0; i < PENDING; i++) m_pend[i].left = 0;
+  m_hwPage = m_hwCol = 0xFF;
+  m_cmdArg = false;
+}
+
+void OledDisplay::stagePush(uint8_t page, uint8_t col, uint8_t b) {
+  uint8_t seg = col >> 3, off = col & 7;
+  Stage* st = NULL;
+  Stage* freeSt = NULL;
+  for (uint8_t i = 0; i < STAGES; i++) {
+    if (m_stage[i].mask == 0) { if (!freeSt) freeSt = &m_stage[i]; continue; }
+    if (m_stage[i].page == page && m_stage[i].seg == seg) { st = &m_stage[i]; break; }
+  }
+  if (!st) {
+    if (!freeSt) {
+      freeSt = &m_stage[m_evict];
+      m_evict = (m_evict + 1) % STAGES;
+      stagePend(*freeSt);
+    }
+    st = freeSt;
+    st->page = page; st->seg = seg;
+  }
+  st->data[off] = b;
+  st->mask |= (uint8_t)(1 << off);
+  if (st->mask != 0xFF) return;
+
+  // Whole segment rewritten: nothing to send if the panel already shows it, whatever
+  // was queued for it since
+  uint16_t bit = (uint16_t)1 << seg;
+  Pend* pd = pendFind(page, seg, false);
+  uint8_t any = 0;
+  for (uint8_t i = 0; i < 8; i++) any |= st->data[i];
+  if ((m_segValid[page] & bit) && m_segHash[page][seg] == segHash(st->data)) {
+    m_segBlank[page] &= ~bit;
+    if (pd) pd->left = 0;
+  } else if (!any) {
+    m_segBlank[page] |= bit;
+    if (pd) pd->left = 0;
+  } else {
+    m_segBlank[page] &= ~bit;
+    if (!pd) pd = pendFind(page, seg, true);
+    memcpy(pd->data, st->data, 8);
+    pd->mask = pd->left = 0xFF;
+  }
+  st->mask = 0;
+}
+
+void OledDisplay::stagePend(Stage& st) {
+  // Partial segment: the written columns are queued as they are
+  uint16_t bit = (uint16_t)1 << st.seg;
+  Pend* pd = pendFind(st.page, st.seg, true);
+  if (m_segBlank[st.page] & bit) {
+    // Still to be cleared: the rest of the segment goes out as zeros
+    m_segBlank[st.page] &= ~bit;
+    memset(pd->data, 0, 8);
+    pd->mask = pd->left = 0xFF;
+  }
+  for (uint8_t i = 0; i < 8; i++)
+    if (st.mask & (1 << i)) pd->data[i] = st.data[i];
+  pd->mask |= st.mask;
+  pd->left |= st.mask;
+  st.mask = 0;
+}
+
+void OledDisplay::stageFlush() {
+  for (uint8_t i = 0; i < STAGES; i++)
+    if (m_stage[i].mask) stagePend(m_stage[i]);
+}
+
+OledDisplay::Pend* OledDisplay::pendFind(uint8_t page, uint8_t seg, bool make) {
+  Pend* freePd = NULL;
+  for (uint8_t i = 0; i < PENDING; i++) {
+    if (m_pend[i].left == 0) { if (!freePd) freePd = &m_pend[i]; continue; }
+    if (m_pend[i].page == page && m_pend[i].seg == seg) return &m_pend[i];
+  }
+  if (!make) return NULL;
+  if (!freePd) {
+    // Queue full: one segment goes out now, whole, whatever the budget
+    freePd = &m_pend[m_pendEvict];
+    m_pendEvict = (m_pendEvict + 1) % PENDING;
+    pendSend(*freePd, false);
+  }
+  freePd->page = page; freePd->seg = seg;
+  freePd->mask = freePd->left = 0;
+  return freePd;
+}
+
+bool OledDisplay::pendSend(Pend& pd, bool budgeted) {
+  uint16_t bit = (uint16_t)1 << pd.seg;
+  uint8_t off = 0;
+  while (pd.left) {
+    while (!(pd.left & (1 << off))) off++;
+    uint8_t start = off;
+    while (off < 8 && (pd.left & (1 << off))) off++;
+    uint8_t n = off - start;
+    if (budgeted) {
+      uint8_t r = room();
+      if (r <= CURSOR_BYTES) return false;
+      if (n > r - CURSOR_BYTES) n = r - CURSOR_BYTES;
+    }
+    // Sent in part, the segment's content is no longer known
+    m_segValid[pd.page] &= ~bit;
+    sendCursor(pd.page, pd.seg * 8 + start);
+    sendData(&pd.data[start], n);
+    pd.left &= (uint8_t)~(((1 << n) - 1) << start);
+    off = start + n;
+  }
+  if (pd.mask == 0xFF) {
+    m_segHash[pd.page][pd.seg] = segHash(pd.data);
+    m_segValid[pd.page] |= bit;
+  }
+  return true;
+}
+
+bool OledDisplay::blankSend() {
+  static const uint8_t zeros[8] = {0};
+  uint16_t h = segHash(zeros);
+  for (uint8_t page = 0; page < 8; page++) {
+    for (uint8_t seg = 0; m_segBlank[page] >> seg; seg++) {
+      uint16_t bit = (uint16_t)1 << seg;
+      if (!(m_segBlank[page] & bit)) continue;
+      // Adjacent segments continue the data stream without another cursor move
+      uint8_t r = room();
+      if (r < CURSOR_BYTES + 8) return false;
+      sendCursor(page, seg * 8);
+      sendData(zeros, 8);
+      m_segHash[page][seg] = h;
+      m_segValid[page] |= bit;
+      m_segBlank[page] &= ~bit;
+    }
+  }
+  return true;
+}
+
+bool OledDisplay::shadowFlush() {
+  // The queue goes out as far as the budget allows. Partial segments join it once it
+  // is empty, so they never push a segment out past the budget.
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    for (uint8_t i = 0; i < PENDING; i++)
+      if (m_pend[i].left && !pendSend(m_pend[i])) return false;
+    if (pass == 0) stageFlush();
+  }
+  return blankSend();
+}
+
+#else
+
+void OledDisplay::shadowReset() {}
+bool OledDisplay::shadowFlush() { return true; }
+
+#endif
@@ -0,0 +1,143 @@
+#pragma once
+// Included from defines.h after the SSD1306Ascii transport headers.
+
+// SSD1306Ascii display with an optional shadow framebuffer (CFG_OLED_SHADOW).
+// With the shadow on, drawing only updates RAM; flush() sends the changed column runs
+// of each page. Nothing reaches the panel that is already there, so clear-and-redraw
+// sequences no longer flicker.
+//   0: off, every byte goes straight to the panel (library behaviour)
+//   1: full 1 KB copy of the panel (ESP32)
+//   2: 16-bit hash per 8-column segment; writes are collected per segment and a
+//      fully rewritten segment is skipped if its hash matches. Changed segments wait
+//      in a short queue, blanked ones in a bitmap; only when the queue overflows does
+//      a segment go out while drawing (~530 B RAM, fits AVR)
+// The flush budget and its chunking apply to modes 1 and 2; mode 0 sends as it draws.
+//
+// On I2C the transport batches too: commands (Co=1 pairs) and the data that follows
+// them share one transaction, filled up to the Wire buffer, instead of one
+// transaction per command and per 17 data bytes. A transaction stays open until it is
+// full, data is followed by a command, or flush() ends it; flush() must be called
+// before anything else uses the bus.
+//
+// With OLED_TWI_ASYNC (AVR) the transactions go into the TWI queue instead of Wire and
+// are sent by the TWI interrupt; flush() hands over the last one and returns. A
+// budgeted flush also stops when the queue is full instead of waiting for it.
+// OLED_SPI_DMA (ESP32) works the same way: runs of commands or data become frames that
+// the SPI driver sends by DMA.
+#if defined(OLED_SPI_DMA)
+  // SSD1306AsciiSpi's begin() on the ESP32 SPI master driver
+  class OledSpiDmaBase : public SSD1306Ascii {
+  public:
+    void begin(const DevType* dev, int8_t cs, int8_t dc, int8_t rst) {
+      spiDmaBegin(cs, dc);
+      if (rst >= 0) {
+        pinMode(rst, OUTPUT);
+        digitalWrite(rst, LOW); delay(10);
+        digitalWrite(rst, HIGH); delay(10);
+      }
+      init(dev);
+    }
+  };
+  typedef OledSpiDmaBase OledBase;
+#elif defined(DISPLAY_SPI)
+  typedef SSD1306AsciiSpi OledBase;
+#elif defined(OLED_TWI_ASYNC)
+  // SSD1306AsciiWire's begin() without Wire
+  class OledTwiBase : public SSD1306Ascii {
+  public:
+    void begin(const DevType* dev, uint8_t i2cAddr) { m_i2cAddr = i2cAddr; init(dev); }
+  protected:
+    uint8_t m_i2cAddr;
+  };
+  typedef OledTwiBase OledBase;
+#else
+  typedef SSD1306AsciiWire OledBase;
+#endif
+
+class OledDisplay : public OledBase {
+public:
+  // Same arguments as the library begin(), but only the init command table is sent.
+  // The full-panel clear the library ends init() with is dropped: with a shadow the
+  // panel is marked to be cleared by the next flushes, without one the caller clears it.
+  template <typename... Args>
+  void begin(const DevType* dev, Args... args) {
+    m_initLeft = readFontByte(&dev->initSize);
+    m_init = true;
+    OledBase::begin(dev, args...);
+    busEnd();
+    m_init = false;
+    shadowReset();
+    m_direct = (CFG_OLED_SHADOW == 0);
+  }
+
+  // Send what changed since the last flush and end the open bus transaction. With a
+  // budget, stops before the transfer would take longer than budgetUs (estimated from
+  // past flushes) or would have to wait for the TWI queue; the rest goes out with the
+  // next flush. NO_WAIT: no time limit, but no waiting either. Returns true when
+  // nothing is left to send.
+  static const uint32_t NO_BUDGET = 0xFFFFFFFFUL;
+  static const uint32_t NO_WAIT = NO_BUDGET - 1;
+  bool flush(uint32_t budgetUs = NO_BUDGET);
+
+#if defined(DISPLAY_I2C)
+  // Transactions sent and how many of them failed (NACK, timeout, bus error) since
+  // the last call
+  void takeBusStats(uint16_t& sent, uint16_t& failed);
+  // Transactions that failed in a row, up to the last one sent
+  uint8_t failStreak();
+#endif
+
+protected:
+  void writeDisplay(uint8_t b, uint8_t mode) override;
+
+private:
+  void busWrite(uint8_t b, uint8_t mode);
+  void busEnd();
+  void shadowReset();
+  bool shadowFlush();
+  uint8_t room();   // bytes the rest of the flush budget (and the TWI queue) allows
+  void sendCursor(uint8_t page, uint8_t col);
+  void sendData(const uint8_t* p, uint8_t n);
+
+  bool m_direct = true;
+  bool m_init = false;                   // in begin()
+  uint8_t m_initLeft = 0;                // init table commands still to send
+  bool m_cmdArg = false;                 // next command byte is an argument (contrast)
+  uint8_t m_hwPage = 0xFF, m_hwCol = 0xFF; // panel address pointer, 0xFF = unknown
+  uint32_t m_flushStart = 0, m_budget = NO_BUDGET;
+  uint16_t m_sent = 0;                   // bytes sent by the current flush
+  uint16_t m_usPerByte = 100;            // learned transfer cost (100 kHz I2C to start)
+#if defined(DISPLAY_I2C) || defined(OLED_SPI_DMA)
+  uint8_t m_txLen = 0;                   // bytes queued in the open transaction, 0 = none
+  bool m_txData = false;                 // open transaction is in its data stream
+#endif
+#if defined(DISPLAY_I2C)
+  uint16_t m_txCount = 0, m_txFailed = 0;
+  uint8_t m_failStreak = 0;
+#endif
+#if CFG_OLED_SHADOW == 1
+  uint8_t m_shadow[8][128];
+  uint8_t m_dirty[8][16];                // bit per column
+#elif CFG_OLED_SHADOW == 2
+  // Segments being written. Glyphs are drawn page by page, so a multi-page glyph
+  // touches several segments before any of them is complete.
+  struct Stage { uint8_t page, seg, mask; uint8_t data[8]; };
+  static const uint8_t STAGES = 4;
+  // Changed segments waiting for flush(): columns written and columns not sent yet.
+  // A slot is free when nothing is left to send.
+  struct Pend { uint8_t page, seg, mask, left; uint8_t data[8]; };
+  static const uint8_t PENDING = 16;
+  void stagePush(uint8_t page, uint8_t col, uint8_t b);
+  void stagePend(Stage& st);
+  void stageFlush();
+  Pend* pendFind(uint8_t page, uint8_t seg, bool make);
+  bool pendSend(Pend& pd, bool budgeted = true);
+  bool blankSend();
+  uint16_t m_segHash[8][16];             // what the panel shows
+  uint16_t m_segValid[8];                // bit per segment
+  uint16_t m_segBlank[8];                // segments flush() has to clear
+  Stage m_stage[STAGES];
+  Pend m_pend[PENDING];
+  uint8_t m_evict = 0, m_pendEvict = 0;
+#endif
+};
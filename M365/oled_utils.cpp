@@ -1,115 +1,277 @@
 #include "oled_utils.h"
+#include "ui_cache.h"
 
-#ifdef DISPLAY_I2C
-static bool s_i2cFast = false;     // false: 100kHz, true: 400kHz
-static uint8_t s_consecOK = 0;     // consecutive OK pings
+// Panel controller (CFG_OLED_SH1106)
+#if CFG_OLED_SH1106
+#define OLED_DEV SH1106_128x64
+#else
+#define OLED_DEV Adafruit128x64
 #endif
 
-bool i2cCheckAndRecover() {
 #ifdef DISPLAY_I2C
+// Clock ladder (CFG_I2C_MAX_HZ). A step that failed is not tried again before the next
+// boot; the saved step is where the next boot starts.
+static const uint32_t CLOCK_STEPS[] = {100000L, 400000L, 700000L, 1000000L};
+static const uint8_t CLOCK_STEP_COUNT = sizeof(CLOCK_STEPS) / sizeof(CLOCK_STEPS[0]);
+// The AVR TWI and the SH1106 stop at Fast-mode, whatever CFG_I2C_MAX_HZ says
+#if defined(ARDUINO_ARCH_AVR) || CFG_OLED_SH1106
+static const uint32_t CLOCK_HW_MAX = 400000L;
+#else
+static const uint32_t CLOCK_HW_MAX = 1000000L;
+#endif
+static const int EEPROM_CLOCK_STEP = 15;
+static const uint16_t WINDOWS_STEP_UP = CFG_I2C_STEP_UP_S * 2;   // 500 ms windows
+static const uint16_t WINDOWS_SAVE = 120;                        // one minute
+static uint8_t s_clockStep = 0;
+static uint8_t s_clockTop = 0;      // fastest step still allowed
+static uint8_t s_clockSaved = 0xFF; // 0xFF: nothing saved
+static uint16_t s_cleanWindows = 0; // windows with traffic and no errors at this step
+
+#if defined(OLED_TWI_ASYNC)
+static bool busPing() { return twiProbe(OLED_I2C_ADDRESS); }
+static void busStart() { twiBegin(); }
+static void busStop() { twiEnd(); }
+static void busClock(uint32_t hz) { twiSetClock(hz); }
+#else
+static bool busPing() {
   Wire.beginTransmission(OLED_I2C_ADDRESS);
-  uint8_t err = Wire.endTransmission();
-  if (err == 0) return true;
+  return Wire.endTransmission() == 0;
+}
+static void busStart() {
+  Wire.begin();
+  Wire.setClock(100000L);
+  #ifdef WIRE_HAS_TIMEOUT
+    Wire.setWireTimeout(25000, true);
+  #endif
+}
+static void busStop() {
+  #if defined(WIRE_HAS_END)
+    Wire.end();
+  #endif
+}
+static void busClock(uint32_t hz) { Wire.setClock(hz); }
+#endif
 
-  #if defined(SDA) && defined(SCL)
-    pinMode(SDA, INPUT_PULLUP);
-    pinMode(SCL, INPUT_PULLUP);
+static void clockLoad() {
+  static bool loaded = false;
+  if (loaded) return;
+  loaded = true;
+  while (s_clockTop + 1 < CLOCK_STEP_COUNT && CLOCK_STEPS[s_clockTop + 1] <= CFG_I2C_MAX_HZ &&
+         CLOCK_STEPS[s_clockTop + 1] <= CLOCK_HW_MAX) s_clockTop++;
+  s_clockSaved = EEPROM.read(EEPROM_CLOCK_STEP);
+  if (s_clockSaved > s_clockTop) s_clockSaved = 0xFF;
+  s_clockStep = (s_clockSaved == 0xFF) ? 0 : s_clockSaved;
+}
 
-    if (digitalRead(SDA) == LOW) {
-      pinMode(SCL, OUTPUT);
-      for (uint8_t i = 0; i < 20 && digitalRead(SDA) == LOW; i++) {
+static void clockSave(uint8_t step) {
+  s_clockSaved = step;
+  EEPROM.put(EEPROM_CLOCK_STEP, step);
+  EEPROM_COMMIT();
+}
+
+// Errors at the current step: one step down and stay below it
+static void clockFailed() {
+  s_cleanWindows = 0;
+  if (s_clockStep > 0) {
+    s_clockStep--;
+    s_clockTop = s_clockStep;
+    if (s_clockSaved != 0xFF && s_clockSaved > s_clockStep) clockSave(s_clockStep);
+  }
+  busClock(CLOCK_STEPS[s_clockStep]);
+}
+
+// A window of display traffic without errors
+static void clockClean() {
+  if (s_cleanWindows < 0xFFFF) s_cleanWindows++;
+  if (s_cleanWindows == WINDOWS_SAVE && s_clockSaved != s_clockStep) clockSave(s_clockStep);
+  if (s_clockStep < s_clockTop && s_cleanWindows >= WINDOWS_STEP_UP) {
+    s_clockStep++;
+    s_cleanWindows = 0;
+    busClock(CLOCK_STEPS[s_clockStep]);
+  }
+}
+
+uint32_t i2cClockHz() { return CLOCK_STEPS[s_clockStep]; }
+#endif
+
+#ifdef DISPLAY_I2C
+// Bus recovery, one step per oledService() call so the loop keeps serving the scooter
+// bus meanwhile: release the pins, clock a stuck slave free one SCL pulse at a time,
+// STOP, restart the bus, ping, send the panel's init commands, clear it. Bit-banging
+// waits ~15 us at most. The init step sends only the command table (about 50 bytes,
+// queued on the TWI); with a shadow the clear is left to the budgeted flushes that
+// follow, without one it takes a quarter page per step.
+enum RecoverStep : uint8_t {
+  REC_IDLE, REC_RELEASE, REC_CLOCK, REC_STOP, REC_START, REC_PING, REC_INIT, REC_CLEAR,
+  REC_RETRY
+};
+static RecoverStep s_rec = REC_IDLE;
+static uint8_t s_recPulses = 0;
+static uint8_t s_recClear = 0;                 // quarter pages cleared
+static uint32_t s_recStart = 0, s_recAt = 0;   // millis() of the fault / of the last step
+static OLED_RECOVERY_t s_recStats = {0, 0, 0};
+static const uint8_t RECOVER_PULSES = 20;
+static const uint16_t RECOVER_RETRY_MS = 500;  // panel still silent: wait, then start over
+
+static void recoverStart() {
+  s_recStart = millis();
+  s_rec = REC_RELEASE;
+}
+
+// Advance to next after waitMs since the last step
+static bool recoverWait(uint16_t waitMs) {
+  return millis() - s_recAt >= waitMs;
+}
+
+static void recoverStep() {
+  switch (s_rec) {
+    case REC_IDLE:
+      return;
+    case REC_RELEASE:
+      busStop();
+    #if defined(SDA) && defined(SCL)
+      pinMode(SDA, INPUT_PULLUP);
+      pinMode(SCL, INPUT_PULLUP);
+    #endif
+      s_recPulses = 0;
+      s_rec = REC_CLOCK;
+      break;
+    case REC_CLOCK:
+    #if defined(SDA) && defined(SCL)
+      // A slave holding SDA low gets one clock per step until it lets go
+      if (digitalRead(SDA) == LOW && s_recPulses < RECOVER_PULSES) {
+        if (s_recPulses++ == 0) pinMode(SCL, OUTPUT);
         digitalWrite(SCL, HIGH);
         delayMicroseconds(5);
         digitalWrite(SCL, LOW);
         delayMicroseconds(5);
+        return;
       }
       pinMode(SCL, INPUT_PULLUP);
+    #endif
+      s_rec = REC_STOP;
+      break;
+    case REC_STOP:
+    #if defined(SDA) && defined(SCL)
+      pinMode(SDA, OUTPUT);
+      digitalWrite(SDA, LOW);
+      delayMicroseconds(5);
+      pinMode(SCL, OUTPUT);
+      digitalWrite(SCL, HIGH);
+      delayMicroseconds(5);
+      digitalWrite(SDA, HIGH);
+      delayMicroseconds(5);
+      pinMode(SDA, INPUT_PULLUP);
+      pinMode(SCL, INPUT_PULLUP);
+    #endif
+      s_rec = REC_START;
+      break;
+    case REC_START:
+      if (!recoverWait(1)) return;
+      busStart();
+      busClock(CLOCK_STEPS[s_clockStep]);
+      s_rec = REC_PING;
+      break;
+    case REC_PING:
+      if (!recoverWait(1)) return;
+      s_rec = busPing() ? REC_INIT : REC_RETRY;
+      break;
+    case REC_INIT:
+      oledInit(false);
+      s_recClear = 0;
+      s_rec = REC_CLEAR;
+      break;
+    case REC_CLEAR: {
+    #if CFG_OLED_SHADOW == 0
+      if (s_recClear < 32) {
+        uint8_t c0 = (s_recClear & 3) * 32;
+        display.clear(c0, c0 + 31, s_recClear >> 2, s_recClear >> 2);
+        display.flush();
+        s_recClear++;
+        return;
+      }
+    #endif
+      s_rec = REC_IDLE;
+      uint32_t ms = millis() - s_recStart;
+      if (ms > 0xFFFF) ms = 0xFFFF;
+      s_recStats.lastMs = (uint16_t)ms;
+      if (ms > s_recStats.maxMs) s_recStats.maxMs = (uint16_t)ms;
+      if (s_recStats.count < 0xFFFF) s_recStats.count++;
+      break;
     }
+    case REC_RETRY:
+      if (!recoverWait(RECOVER_RETRY_MS)) return;
+      s_rec = REC_RELEASE;
+      break;
+  }
+  s_recAt = millis();
+}
+#endif
 
-    pinMode(SDA, OUTPUT);
-    digitalWrite(SDA, LOW);
-    delayMicroseconds(5);
-    pinMode(SCL, OUTPUT);
-    digitalWrite(SCL, HIGH);
-    delayMicroseconds(5);
-    digitalWrite(SDA, HIGH);
-    delayMicroseconds(5);
-    pinMode(SDA, INPUT_PULLUP);
-    pinMode(SCL, INPUT_PULLUP);
-  #endif
-
-  #if defined(WIRE_HAS_END)
-  Wire.end();
-  #endif
-  delay(1);
-  Wire.begin();
-  Wire.setClock(100000L);
-  #ifdef WIRE_HAS_TIMEOUT
-    Wire.setWireTimeout(25000, true);
-  #endif
-  delay(1);
-
-  Wire.beginTransmission(OLED_I2C_ADDRESS);
-  err = Wire.endTransmission();
-  s_i2cFast = false;
-  s_consecOK = 0;
-  return err == 0;
+bool oledRecovering() {
+#ifdef DISPLAY_I2C
+  return s_rec != REC_IDLE;
 #else
-  return true;
+  return false;
 #endif
 }
 
+#ifdef DISPLAY_I2C
+const OLED_RECOVERY_t& oledRecoveryStats() { return s_recStats; }
+#endif
+
 void oledInit(bool showLogo) {
 #ifdef DISPLAY_I2C
-  #if defined(WIRE_HAS_END)
-    Wire.end();
-  #endif
-  Wire.begin();
-  Wire.setClock(100000L);
-  #ifdef WIRE_HAS_TIMEOUT
-    Wire.setWireTimeout(25000, true);
-  #endif
-  display.begin(&Adafruit128x64, OLED_I2C_ADDRESS);
-  s_i2cFast = false;
-  s_consecOK = 0;
+  busStop();
+  busStart();
+  clockLoad();
+  busClock(CLOCK_STEPS[s_clockStep]);
+  display.begin(&OLED_DEV, OLED_I2C_ADDRESS);
 #endif
 #ifdef DISPLAY_SPI
-  display.begin(&Adafruit128x64, PIN_CS, PIN_DC, PIN_RST);
+  display.begin(&OLED_DEV, PIN_CS, PIN_DC, PIN_RST);
 #endif
   display.setFont(defaultFont);
+  // The panel is blank once flushed (or cleared by the caller); everything has to be
+  // drawn again
+  uiCacheInvalidate();
   if (showLogo) {
     display.clear();
     display.setFont(m365);
     display.setCursor(0, 0);
     display.print((char)0x20);
     display.setFont(defaultFont);
+    display.flush();
   }
 }
 
 void oledService() {
 #ifdef DISPLAY_I2C
+  if (s_rec != REC_IDLE) { recoverStep(); return; }
   static uint32_t nextCheck = 0;
   uint32_t now = millis();
   if ((int32_t)(now - nextCheck) >= 0) {
     nextCheck = now + 500;
     if (oledBusy) return;
-    if (i2cCheckAndRecover()) {
-      if (!s_i2cFast) {
-        if (s_consecOK < 255) s_consecOK++;
-        if (s_consecOK >= 8) {
-          Wire.setClock(400000L);
-          s_i2cFast = true;
-        }
-      }
-    } else {
-      #ifdef DISPLAY_I2C
-        Wire.setClock(100000L);
-      #endif
-      s_i2cFast = false;
-      s_consecOK = 0;
-      if (!oledBusy) {
-        oledInit(false);
-      }
+    // Health comes from the display's own transactions; the bus is only pinged
+    // when nothing has been written for CFG_OLED_PING_S
+    static uint16_t quietWindows = 0;
+    uint16_t sent, failed;
+    display.takeBusStats(sent, failed);
+    bool down = display.failStreak() >= CFG_OLED_FAIL_STREAK;
+    if (sent) {
+      quietWindows = 0;
+    } else if (++quietWindows >= CFG_OLED_PING_S * 2) {
+      quietWindows = 0;
+      down = !busPing();
+    }
+    if (down) {
+      clockFailed();
+      recoverStart();
+    } else if ((uint32_t)failed * 100 > (uint32_t)sent * CFG_I2C_ERR_PCT) {
+      clockFailed();
+    } else if (sent) {
+      clockClean();
     }
   }
 #endif
@@ -1,11 +1,29 @@
 #pragma once
 #include "defines.h"
 
-// Attempt to detect and recover a stuck I2C bus, then verify OLED presence
-bool i2cCheckAndRecover();
-
 // Initialize the OLED display and I2C/SPI bus
 void oledInit(bool showLogo);
 
-// Lightweight periodic health check; re-inits OLED upon hiccup
+// Periodic health check from the results of the display's own I2C transactions: recovers
+// the bus and re-inits the OLED after CFG_OLED_FAIL_STREAK failures in a row (or a
+// failed ping when nothing was written for CFG_OLED_PING_S) and adapts the clock to the
+// error rate (CFG_I2C_MAX_HZ). Call every loop pass: a recovery advances one short step
+// per call.
 void oledService();
+
+// True while oledService() is recovering the I2C bus: nothing may be drawn or sent
+// over I2C (the sensor included) until it returns false
+bool oledRecovering();
+
+#ifdef DISPLAY_I2C
+// Current OLED bus clock
+uint32_t i2cClockHz();
+
+// Completed recoveries and how long they took, from the fault to the re-initialized panel
+struct OLED_RECOVERY_t {
+  uint16_t count;
+  uint16_t lastMs;
+  uint16_t maxMs;
+};
+const OLED_RECOVERY_t& oledRecoveryStats();
+#endif
@@ -47,6 +47,7 @@ static uint16_t g_next_seq = 1;      // next sequence index when writing
 static uint8_t g_midride_written = 0; // at most one mid-ride write
 static uint32_t g_last_checkpoint_ms = 0;
 static uint8_t g_full_soc_seen = 100; // track highest SOC seen since last reset
+static bool g_learned = false;       // km/% came from EEPROM or from riding
 
 // Helpers to convert units
 static inline uint32_t odo_to_m(uint32_t mileageTotal_centi_km) {
@@ -55,7 +56,7 @@ static inline uint32_t odo_to_m(uint32_t mileageTotal_centi_km) {
 }
 
 // CRC16-CCITT (FALSE) implementation
-static uint16_t crc16_ccitt_false(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+uint16_t crc16_ccitt_false(const uint8_t* data, size_t len, uint16_t crc) {
   for (size_t i = 0; i < len; ++i) {
     crc ^= (uint16_t)data[i] << 8;
     for (uint8_t b = 0; b < 8; ++b) {
@@ -122,6 +123,14 @@ static void clampLearned() {
 
 float rangeGetKmPerPct() { return g_km_per_pct; }
 
+void rangeSetPackCapacity(uint16_t mAh) {
+  // RANGE_KM_PER_PCT_INIT is tuned for PACK1_MAH + PACK2_MAH; rescale it to the real
+  // capacity of the monitored pack until the learner has its own value
+  if (g_learned || mAh == 0) return;
+  g_km_per_pct = KM_PER_PCT_INIT * ((float)mAh + (float)PACK2_MAH) / ((float)PACK1_MAH + (float)PACK2_MAH);
+  clampLearned();
+}
+
 float rangeGetEstimateKm() {
   // SoC_now from S25C31.remainPercent
   float soc = (float)S25C31.remainPercent;
@@ -154,6 +163,7 @@ void rangeInit() {
   if (idx >= 0) {
     RangeSlot s; readSlot(idx, s);
     g_km_per_pct = s.km_per_pct; clampLearned();
+    g_learned = true;
     g_next_seq = s.seq + 1;
     g_last_soc = s.last_soc;
     g_last_odo_m = s.last_odo_m;
@@ -228,6 +238,7 @@ void rangeTick() {
     float old = g_km_per_pct;
     g_km_per_pct = (1.0f - EMA_ALPHA) * g_km_per_pct + EMA_ALPHA * km_per_pct;
     clampLearned();
+    g_learned = true;
 
     // Hysteresis for dirty flag
   float delta = g_km_per_pct - old; if (delta < 0) delta = -delta;
@@ -254,6 +265,7 @@ void rangeTick() {
         float old = g_km_per_pct;
         g_km_per_pct = (1.0f - EOD_BETA) * g_km_per_pct + EOD_BETA * eod_km_per_pct;
         clampLearned();
+        g_learned = true;
   float delta = g_km_per_pct - old; if (delta < 0) delta = -delta;
         if (delta >= 0.01f || delta >= (0.05f * old)) {
           scheduleDirty();
@@ -10,6 +10,12 @@ void rangeTick();
 // Optional explicit checkpoint (e.g., on orderly shutdown/hibernate)
 void rangeCheckpointIfNeeded();
 
+// Pack design capacity from the BMS; seeds km/% while nothing has been learned yet
+void rangeSetPackCapacity(uint16_t mAh);
+
+// CRC16-CCITT (FALSE) used for the EEPROM records (range ring, device info)
+uint16_t crc16_ccitt_false(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
 // Accessors
 float rangeGetKmPerPct();
 float rangeGetEstimateKm();
@@ -0,0 +1,74 @@
+#include "render_task.h"
+
+#if RENDER_TASK
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "display_fsm.h"
+#include "frame_sched.h"
+#include "oled_utils.h"
+#include "aht10.h"
+
+#if CFG_OLED_SHADOW == 0
+#error "CFG_RENDER_TASK needs CFG_OLED_SHADOW: without it drawing is I2C time spent under the state lock"
+#endif
+
+static const uint32_t RENDER_STACK = 4096;
+static SemaphoreHandle_t s_lock = NULL;
+
+bool renderTryLock() { return xSemaphoreTake(s_lock, 0) == pdTRUE; }
+void renderLock() { xSemaphoreTake(s_lock, portMAX_DELAY); }
+void renderUnlock() { xSemaphoreGive(s_lock); }
+
+static void renderTask(void*) {
+  TickType_t last = xTaskGetTickCount();
+  for (;;) {
+    if (!oledRecovering() && frameDue()) {
+      uint32_t t0 = micros();
+      renderLock();
+      displayFSM();
+      renderUnlock();
+      uint32_t t1 = micros();
+      // The shadow framebuffer is only touched by this task; the transfer needs no lock
+      display.flush();
+      frameDone(t0, t1);
+    }
+#if CFG_AHT10_ENABLE
+    static uint32_t nextAht = 0;
+    uint32_t now = millis();
+    if ((int32_t)(now - nextAht) >= 0 && !oledRecovering()) {
+      nextAht = now + 500;
+      float t, h; (void)aht10Read(t, h);
+    }
+#endif
+    oledService();
+    vTaskDelayUntil(&last, pdMS_TO_TICKS(CFG_RENDER_POLL_MS));
+  }
+}
+
+void renderInit() {
+  if (!s_lock) s_lock = xSemaphoreCreateMutex();
+}
+
+void renderTaskStart() {
+  static bool started = false;
+  if (started) return;
+  started = true;
+  renderInit();
+#if CONFIG_FREERTOS_UNICORE
+  // One core: the loop task moves one priority up and preempts drawing as soon as it
+  // is ready to run again
+  UBaseType_t prio = uxTaskPriorityGet(NULL);
+  vTaskPrioritySet(NULL, prio + 1);
+  xTaskCreate(renderTask, "render", RENDER_STACK, NULL, prio, NULL);
+#else
+  xTaskCreatePinnedToCore(renderTask, "render", RENDER_STACK, NULL, 1, NULL, ARDUINO_RUNNING_CORE ? 0 : 1);
+#endif
+}
+
+void renderYield() {
+#if CONFIG_FREERTOS_UNICORE
+  // The loop task never blocks on its own; one tick is well within the UART buffers
+  vTaskDelay(1);
+#endif
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+#include "defines.h"
+
+// ESP32 render task (CFG_RENDER_TASK). displayFSM(), the OLED flush, the OLED health
+// check and the AHT10 run in their own FreeRTOS task; the loop task keeps the bus.
+//
+// One state lock guards telemetry, menus and settings. The render task holds it while
+// drawing into the shadow framebuffer, never during the I2C transfer. The bus side only
+// tries it: frames that arrive while it is held are applied on a later pass (comms.cpp),
+// so bus handling never waits for the display.
+#if defined(ARDUINO_ARCH_ESP32) && CFG_RENDER_TASK
+  #define RENDER_TASK 1
+#else
+  #define RENDER_TASK 0
+#endif
+
+#if RENDER_TASK
+#include "freertos/FreeRTOS.h"
+
+// Create the state lock; call first thing in setup(), before any bus frame is processed
+void renderInit();
+// Start the task; call once the display is up (end of setup)
+void renderTaskStart();
+
+bool renderTryLock();
+void renderLock();
+void renderUnlock();
+
+// Loop task, once per pass: hand the CPU to the render task on single-core chips
+void renderYield();
+#endif
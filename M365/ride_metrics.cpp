@@ -0,0 +1,82 @@
+#include "ride_metrics.h"
+
+static RIDE_METRICS_t s_metrics = {};
+
+// Per-trip aggregates (since power on) from one sample
+static void tripUpdate(const RIDE_METRICS_t& m) {
+  // Track energy: power (W) = current(A) * voltage(V). We have centi-units for I and V.
+  // Compute W*100 from pwh/pwl => integer watts and fractional 0-99.
+  uint32_t P_Wx100 = (uint32_t)m.pwh * 100UL + (uint32_t)m.pwl;
+  // Integrate energy in Wh*100 using elapsed seconds since last sample of powerOnTime
+  uint32_t pot_s = S23C3A.powerOnTime; // seconds
+  // Detect wrap or reset (e.g. after power cycle)
+  if (lastPowerOnTime_s == 0 || pot_s < lastPowerOnTime_s) {
+    lastPowerOnTime_s = pot_s;
+    // Reset per-trip metrics when starting fresh
+    tripEnergy_Wh_x100 = 0;
+    tripMaxCurrent_cA = 0; tripMaxPower_Wx100 = 0;
+    tripMinVoltage_cV = 0xFFFF; tripMaxVoltage_cV = 0;
+  }
+  uint32_t dt = (pot_s >= lastPowerOnTime_s) ? (pot_s - lastPowerOnTime_s) : 0;
+  if (dt > 0) {
+    // Wh = W * h; Wh*100 = (W*100) * (dt/3600)
+    tripEnergy_Wh_x100 += (P_Wx100 * dt) / 3600UL;
+    lastPowerOnTime_s = pot_s;
+  }
+
+  // Track max current and power (absolute discharge only)
+  uint16_t cur_cA = (uint16_t)abs(m.current_cA); // centi-amps (scaled total)
+  if (cur_cA > tripMaxCurrent_cA) tripMaxCurrent_cA = cur_cA;
+  if (P_Wx100 > tripMaxPower_Wx100) tripMaxPower_Wx100 = P_Wx100;
+
+  // Track min/max voltage
+  uint16_t v_cV = (uint16_t)abs(S25C31.voltage);
+  if (v_cV < tripMinVoltage_cV) tripMinVoltage_cV = v_cV;
+  if (v_cV > tripMaxVoltage_cV) tripMaxVoltage_cV = v_cV;
+}
+
+void rideMetricsUpdate() {
+  RIDE_METRICS_t& m = s_metrics;
+  long _speed;
+  long c_speed;
+
+  if (S23CB0.speed < -10000) {
+    c_speed = S23CB0.speed + 32768 + 32767;
+  } else {
+    c_speed = abs(S23CB0.speed);
+  }
+  m.speedRaw = c_speed;
+
+  if (WheelSize) _speed = (long)c_speed * 10 / 8.5; else _speed = c_speed;
+  m.sph = (uint32_t)abs(_speed) / 1000L;
+  m.spl = (uint16_t)(abs(_speed) % 1000L) / 100;
+#ifdef US_Version
+  m.sph = m.sph/1.609; m.spl = m.spl/1.609;
+#endif
+  m.current_cA = totalCurrent_cA();
+  m.curh = abs(m.current_cA) / 100;
+  m.curl = abs(m.current_cA) % 100;
+  m.vh = abs(S25C31.voltage) / 100;
+  m.vl = abs(S25C31.voltage) % 100;
+  {
+    uint32_t ai = (uint32_t)abs(m.current_cA);
+    uint32_t vi = (uint32_t)abs(S25C31.voltage);
+    uint32_t p = (ai * vi + 50) / 100;
+    m.pwh = (uint16_t)(p / 100);
+    m.pwl = (uint16_t)(p % 100);
+  }
+
+  m.milh = S23CB0.mileageCurrent / 100;
+  m.mill = S23CB0.mileageCurrent % 100;
+  m.Min = S23C3A.ridingTime / 60;
+  m.Sec = S23C3A.ridingTime % 60;
+#ifdef US_Version
+  m.milh = m.milh/1.609; m.mill = m.mill/1.609;
+#endif
+
+  tripUpdate(m);
+}
+
+const RIDE_METRICS_t& rideMetrics() {
+  return s_metrics;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "defines.h"
+
+// Ride values derived from the telemetry globals: speed with the wheel size and units
+// applied, total current of both packs, power, and the display's integer/fraction
+// splits. They are computed once per telemetry frame, together with the per-trip
+// aggregates, so the screens only read them and a loop pass without new data costs
+// nothing.
+struct RIDE_METRICS_t {
+  long speedRaw;              // ESC speed, wrap fixed, before wheel size (<= 200: stationary)
+  uint32_t sph; uint16_t spl; // speed: whole and tenths (km/h or mph)
+  int16_t current_cA;         // total current in centi-amps, negative while regenerating
+  uint16_t curh, curl;        // |current|: A and hundredths
+  uint16_t vh, vl;            // voltage: V and hundredths
+  uint16_t pwh, pwl;          // power: W and hundredths
+  uint16_t milh, mill;        // trip distance: whole and hundredths (km or mi)
+  uint16_t Min, Sec;          // riding time
+};
+
+// Recompute from the telemetry globals and add the sample to the trip aggregates. Called
+// when a frame answering one of our queries has been stored (state lock held).
+void rideMetricsUpdate();
+
+// Values from the last update
+const RIDE_METRICS_t& rideMetrics();
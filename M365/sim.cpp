@@ -1,4 +1,5 @@
 #include "sim.h"
+#include "ride_metrics.h"
 
 #ifdef SIM_MODE
 static bool simManual = false;
@@ -42,6 +43,7 @@ void simInit() {
   for (uint8_t i = 0; i < 10; i++) c[i] = 4150 + (i % 3);
 
   _NewDataFlag = 1;
+  rideMetricsUpdate();
   // Initialize filters
   filtThrottle = 0; filtBrake = 0; filtSpeed = 0;
 
@@ -203,5 +205,6 @@ void simTick() {
 
   _NewDataFlag = 1;
   _Query.prepared = 0;
+  rideMetricsUpdate();
 }
 #endif
@@ -0,0 +1,97 @@
+#include "spi_dma.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && CFG_OLED_SPI && CFG_OLED_SPI_DMA
+#include <driver/spi_master.h>
+#include <driver/gpio.h>
+#include <esp_heap_caps.h>
+
+// Frames use the slots in order; the driver hands finished ones back in the same order,
+// so the oldest queued slot is always the next to be freed.
+static spi_device_handle_t s_dev = nullptr;
+static spi_transaction_t s_trans[SPI_FRAME_SLOTS];
+static uint8_t* s_buf = nullptr;           // SPI_FRAME_SLOTS * SPI_FRAME_MAX, DMA capable
+static uint8_t s_head = 0;                 // slot of the next frame
+static uint8_t s_pending = 0;              // frames queued and not taken back yet
+static uint16_t s_len = 0;
+static bool s_open = false, s_data = false;
+static int s_dcPin = -1;
+
+// Driver callback before each transfer (interrupt context): D/C from the frame type
+static void IRAM_ATTR setDc(spi_transaction_t* t) {
+  gpio_set_level((gpio_num_t)s_dcPin, (int)(intptr_t)t->user);
+}
+
+// Take back the slot of the oldest finished frame; false if there is none
+static bool reclaim(bool wait) {
+  if (s_pending == 0) return false;
+  spi_transaction_t* t;
+  if (spi_device_get_trans_result(s_dev, &t, wait ? portMAX_DELAY : 0) != ESP_OK) return false;
+  s_pending--;
+  return true;
+}
+
+bool spiDmaBegin(int8_t cs, int8_t dc) {
+  if (s_dev) { spiDrain(); return true; }
+  s_dcPin = dc;
+  pinMode(dc, OUTPUT);
+
+  spi_bus_config_t bus = {};
+  bus.mosi_io_num = OLED_SPI_MOSI_PIN;
+  bus.miso_io_num = -1;
+  bus.sclk_io_num = OLED_SPI_SCK_PIN;
+  bus.quadwp_io_num = -1;
+  bus.quadhd_io_num = -1;
+  bus.max_transfer_sz = SPI_FRAME_MAX;
+  if (spi_bus_initialize(SPI2_HOST, &bus, SPI_DMA_CH_AUTO) != ESP_OK) return false;
+
+  spi_device_interface_config_t dev = {};
+  dev.clock_speed_hz = CFG_OLED_SPI_HZ;
+  dev.mode = 0;
+  dev.spics_io_num = cs;
+  dev.queue_size = SPI_FRAME_SLOTS;
+  dev.pre_cb = setDc;
+  if (spi_bus_add_device(SPI2_HOST, &dev, &s_dev) != ESP_OK) { s_dev = nullptr; return false; }
+
+  s_buf = (uint8_t*)heap_caps_malloc(SPI_FRAME_SLOTS * SPI_FRAME_MAX, MALLOC_CAP_DMA);
+  if (!s_buf) { spi_bus_remove_device(s_dev); s_dev = nullptr; return false; }
+  s_head = s_pending = 0;
+  return true;
+}
+
+void spiFrameBegin(bool data) {
+  if (!s_dev) return;
+  if (s_pending == SPI_FRAME_SLOTS) reclaim(true);
+  s_len = 0;
+  s_data = data;
+  s_open = true;
+}
+
+void spiFrameWrite(uint8_t b) {
+  if (!s_open || s_len >= SPI_FRAME_MAX) return;
+  s_buf[s_head * SPI_FRAME_MAX + s_len++] = b;
+}
+
+void spiFrameEnd() {
+  if (!s_open) return;
+  s_open = false;
+  if (s_len == 0) return;
+  spi_transaction_t& t = s_trans[s_head];
+  memset(&t, 0, sizeof(t));
+  t.length = (size_t)s_len * 8;
+  t.tx_buffer = &s_buf[s_head * SPI_FRAME_MAX];
+  t.user = (void*)(intptr_t)s_data;
+  if (spi_device_queue_trans(s_dev, &t, portMAX_DELAY) != ESP_OK) return;
+  s_head = (uint8_t)((s_head + 1) % SPI_FRAME_SLOTS);
+  s_pending++;
+}
+
+bool spiBusy() {
+  while (reclaim(false)) {}
+  return s_pending != 0;
+}
+
+void spiDrain() {
+  while (reclaim(true)) {}
+}
+
+#endif
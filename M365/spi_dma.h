@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// SPI OLED transport for ESP32 (CFG_OLED_SPI with CFG_OLED_SPI_DMA). Each run of
+// command or data bytes is copied into a DMA buffer and queued on the SPI master
+// driver, which sends it in the background and sets D/C from the frame type; the
+// caller only waits when every buffer is still queued. Mirrors twi_queue.h.
+#if defined(ARDUINO_ARCH_ESP32) && CFG_OLED_SPI && CFG_OLED_SPI_DMA
+
+// Largest frame payload (one page row of pixels)
+static const uint16_t SPI_FRAME_MAX = 128;
+// Frames that can be queued at once: a full-screen refresh is 8 cursor moves and
+// 8 page rows, so it never waits
+static const uint8_t SPI_FRAME_SLOTS = 16;
+
+// Set up the bus (SCK/MOSI from config.h), chip select cs and D/C pin dc. Safe to
+// call again; returns false if the driver could not be installed.
+bool spiDmaBegin(int8_t cs, int8_t dc);
+
+// Queue one transfer with D/C low (command) or high (data): spiFrameBegin(), up to
+// SPI_FRAME_MAX spiFrameWrite(), spiFrameEnd(). Nothing is sent before spiFrameEnd().
+void spiFrameBegin(bool data);
+void spiFrameWrite(uint8_t b);
+void spiFrameEnd();
+
+// True while frames are queued or on the wire (takes back finished frames)
+bool spiBusy();
+// Wait until everything queued has been sent
+void spiDrain();
+
+#endif
@@ -0,0 +1,189 @@
+#include "twi_queue.h"
+
+#if defined(ARDUINO_ARCH_AVR) && CFG_OLED_TWI_ASYNC
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+static_assert((CFG_TWI_QUEUE_LEN & (CFG_TWI_QUEUE_LEN - 1)) == 0 && CFG_TWI_QUEUE_LEN <= 256,
+              "CFG_TWI_QUEUE_LEN must be a power of two up to 256");
+static const uint8_t QMASK = (uint8_t)(CFG_TWI_QUEUE_LEN - 1);
+static const uint32_t STALL_US = 25000;
+
+// Ring of frames: addr, len, len data bytes. The producer owns s_head (including the
+// frame being built) and publishes whole frames by moving s_commit; the ISR owns s_tail.
+static uint8_t s_buf[CFG_TWI_QUEUE_LEN];
+static uint8_t s_head = 0, s_frame = 0, s_frameLen = 0;
+static bool s_open = false, s_drop = false; // frame being built / lost to a stall
+static volatile uint8_t s_commit = 0, s_tail = 0;
+static volatile uint8_t s_left = 0;        // data bytes left in the frame on the wire
+static volatile bool s_busy = false;       // ISR owns the bus
+static volatile bool s_failed = false;     // last frame was NACKed or hit a bus error
+static volatile uint8_t s_errors = 0;
+static volatile uint8_t s_failStreak = 0;  // frames failed in a row
+
+static const uint8_t TWCR_RUN = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+
+// Interrupts off, ISR idle and a frame committed. A STOP the ISR has just requested
+// may still be going out; it takes a bit time or two.
+static void startNext() {
+  for (uint8_t i = 0; (TWCR & _BV(TWSTO)) && i < 255; i++) {}
+  TWCR = TWCR_RUN | _BV(TWSTA);
+  s_busy = true;
+}
+
+ISR(TWI_vect) {
+  switch (TW_STATUS) {
+    case TW_START:
+    case TW_REP_START: {
+      uint8_t t = s_tail;
+      TWDR = (uint8_t)(s_buf[t] << 1);   // SLA+W
+      s_left = s_buf[(uint8_t)(t + 1) & QMASK];
+      s_tail = (uint8_t)(t + 2) & QMASK;
+      s_failed = false;
+      TWCR = TWCR_RUN;
+      return;
+    }
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+      if (s_left) {
+        uint8_t t = s_tail;
+        TWDR = s_buf[t];
+        s_tail = (uint8_t)(t + 1) & QMASK;
+        s_left--;
+        TWCR = TWCR_RUN;
+        return;
+      }
+      break;
+    default:
+      // NACK, lost arbitration or bus error: drop the rest of the frame
+      s_tail = (uint8_t)(s_tail + s_left) & QMASK;
+      s_left = 0;
+      s_failed = true;
+      if (s_errors < 255) s_errors++;
+      if (s_failStreak < 255) s_failStreak++;
+      break;
+  }
+  if (!s_failed) s_failStreak = 0;
+  // STOP has no interrupt of its own. With another frame queued the TWI sends STOP and
+  // then START, and the next interrupt is the START; nothing waits for the STOP here.
+  if (s_tail != s_commit) {
+    TWCR = TWCR_RUN | _BV(TWSTO) | _BV(TWSTA);
+  } else {
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    s_busy = false;
+  }
+}
+
+static uint8_t room() {
+  return (uint8_t)(s_tail - s_head - 1) & QMASK;
+}
+
+static void reset() {
+  uint8_t sreg = SREG; cli();
+  TWCR = 0;
+  s_head = s_frame = s_frameLen = 0;
+  s_commit = s_tail = s_left = 0;
+  s_busy = false;
+  s_drop = s_open;
+  TWCR = _BV(TWEN);
+  SREG = sreg;
+}
+
+static void stall() {
+  reset();
+  if (s_errors < 255) s_errors++;
+  if (s_failStreak < 255) s_failStreak++;
+}
+
+// Wait until room() >= need; false if the ISR stalled and the queue was dropped
+static bool waitRoom(uint8_t need) {
+  uint8_t lastTail = s_tail;
+  uint32_t since = micros();
+  while (room() < need) {
+    uint8_t t = s_tail;
+    if (t != lastTail) { lastTail = t; since = micros(); continue; }
+    if (micros() - since > STALL_US) { stall(); return false; }
+  }
+  return true;
+}
+
+void twiBegin() {
+  // Internal pull-ups, as Wire does; the module has its own
+  digitalWrite(SDA, HIGH);
+  digitalWrite(SCL, HIGH);
+  TWSR = 0;
+  twiSetClock(100000L);
+  reset();
+}
+
+void twiEnd() {
+  reset();
+  TWCR = 0;
+  digitalWrite(SDA, LOW);
+  digitalWrite(SCL, LOW);
+}
+
+void twiSetClock(uint32_t hz) {
+  TWBR = (uint8_t)(((F_CPU / hz) - 16) / 2);
+}
+
+void twiFrameBegin(uint8_t addr) {
+  waitRoom(2);
+  s_open = true;
+  s_frame = s_head;
+  s_buf[s_frame] = addr;
+  s_head = (uint8_t)(s_head + 2) & QMASK;
+  s_frameLen = 0;
+}
+
+void twiFrameWrite(uint8_t b) {
+  if (s_frameLen >= TWI_FRAME_MAX || s_drop) return;
+  // A stall resets the queue under the frame; the rest of it is dropped
+  if (!waitRoom(1)) return;
+  s_buf[s_head] = b;
+  s_head = (uint8_t)(s_head + 1) & QMASK;
+  s_frameLen++;
+}
+
+void twiFrameEnd() {
+  s_open = false;
+  if (s_drop) { s_drop = false; return; }
+  s_buf[(uint8_t)(s_frame + 1) & QMASK] = s_frameLen;
+  uint8_t sreg = SREG; cli();
+  s_commit = s_head;
+  if (!s_busy) startNext();
+  SREG = sreg;
+}
+
+uint8_t twiRoom() { return room(); }
+
+bool twiBusy() { return s_busy; }
+
+bool twiDrain() {
+  if (!waitRoom(QMASK)) return false;
+  // The last byte leaves the ring before its ACK and the STOP
+  uint32_t since = micros();
+  while (s_busy) {
+    if (micros() - since > STALL_US) { stall(); return false; }
+  }
+  return true;
+}
+
+bool twiProbe(uint8_t addr) {
+  if (!twiDrain()) return false;
+  twiFrameBegin(addr);
+  twiFrameEnd();
+  return twiDrain() && !s_failed;
+}
+
+uint8_t twiTakeErrors() {
+  uint8_t sreg = SREG; cli();
+  uint8_t n = s_errors;
+  s_errors = 0;
+  SREG = sreg;
+  return n;
+}
+
+uint8_t twiFailStreak() { return s_failStreak; }
+
+#endif
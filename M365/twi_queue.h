@@ -0,0 +1,41 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Interrupt-driven TWI master transmitter for the OLED on AVR (CFG_OLED_TWI_ASYNC).
+// Replaces Wire: each I2C transaction is queued as a frame and the TWI interrupt sends
+// the queue in the background, so drawing returns as soon as the bytes are queued.
+// twiFrameBegin() and twiFrameWrite() wait only when the queue is full; a caller that
+// must not wait checks twiRoom() first.
+#if defined(ARDUINO_ARCH_AVR) && CFG_OLED_TWI_ASYNC
+
+// Largest frame payload; two frames always fit in the queue
+static const uint8_t TWI_FRAME_MAX = CFG_TWI_QUEUE_LEN / 2 - 2;
+
+// Take over SDA/SCL (internal pull-ups on) at 100 kHz; drops anything queued
+void twiBegin();
+// Release the pins, e.g. to clock a stuck bus free
+void twiEnd();
+void twiSetClock(uint32_t hz);
+
+// Queue one transaction to addr: twiFrameBegin(), up to TWI_FRAME_MAX twiFrameWrite(),
+// twiFrameEnd(). Nothing is sent before twiFrameEnd().
+void twiFrameBegin(uint8_t addr);
+void twiFrameWrite(uint8_t b);
+void twiFrameEnd();
+// Free bytes in the queue. A frame takes 2 bytes plus its data.
+uint8_t twiRoom();
+
+// True while frames are queued or on the wire
+bool twiBusy();
+// Wait for the queue to drain. A bus that makes no progress for 25 ms is reset and
+// the queue dropped; returns false then.
+bool twiDrain();
+// Address-only transaction after draining the queue; true if the device ACKed
+bool twiProbe(uint8_t addr);
+// NACKs and bus errors since the last call
+uint8_t twiTakeErrors();
+// Frames that failed in a row, up to the last one sent (0 once one gets through)
+uint8_t twiFailStreak();
+
+#endif
@@ -0,0 +1,97 @@
+#include "uart_tx.h"
+
+static volatile bool s_txBusy = false;
+static volatile uint32_t s_txDoneUs = 0;
+
+#if defined(ARDUINO_ARCH_AVR) && defined(UCSR0B) && defined(TXCIE0)
+#include <avr/interrupt.h>
+
+// The core only claims the RX and UDRE vectors, so transmit-complete is ours.
+// It fires once the last stop bit has left the shift register.
+ISR(USART_TX_vect) {
+  UCSR0B &= ~_BV(TXCIE0);
+  RX_ENABLE;
+  s_txDoneUs = micros();
+  s_txBusy = false;
+}
+
+bool uartTxSend(const uint8_t* frame, uint8_t len) {
+  if (s_txBusy) return false;
+  if (XIAOMI_PORT.availableForWrite() < len) return false;
+  s_txBusy = true;
+  RX_DISABLE;
+  // Lands in the core TX ring without spinning; write() also clears a stale TXC
+  XIAOMI_PORT.write(frame, len);
+  UCSR0B |= _BV(TXCIE0);
+  return true;
+}
+
+bool uartTxBusy() { return s_txBusy; }
+
+uint32_t uartTxDoneMicros() {
+  uint32_t t;
+  uint8_t sreg = SREG; cli(); t = s_txDoneUs; SREG = sreg;
+  return t;
+}
+
+// RX is off while we transmit, so our own frame never reaches the decoder
+bool uartRxIsEcho(const m365proto::FrameHeader&, const uint8_t*) { return false; }
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <driver/uart.h>
+
+// The RX pin stays live and hears our own frame; keep a copy to recognise it
+static uint8_t s_echo[sizeof(_Query.buf)];
+static uint8_t s_echoLen = 0;
+
+bool uartTxSend(const uint8_t* frame, uint8_t len) {
+  if (uartTxBusy()) return false;
+  if (len > sizeof(s_echo) || XIAOMI_PORT.availableForWrite() < len) return false;
+  memcpy(s_echo, frame, len);
+  s_echoLen = len;
+  XIAOMI_PORT.write(frame, len);
+  s_txBusy = true;
+  return true;
+}
+
+// The driver reports when the FIFO and shift register are empty; a zero timeout
+// makes this a poll, so the done time is as late as the caller's next check.
+bool uartTxBusy() {
+  if (s_txBusy && uart_wait_tx_done(XIAOMI_UART_NUM, 0) == ESP_OK) {
+    s_txDoneUs = micros();
+    s_txBusy = false;
+  }
+  return s_txBusy;
+}
+
+uint32_t uartTxDoneMicros() { return s_txDoneUs; }
+
+bool uartRxIsEcho(const m365proto::FrameHeader& hdr, const uint8_t* payload) {
+  uint8_t n = hdr.len - 2;
+  if (s_echoLen != (uint8_t)(n + m365proto::FRAME_OVERHEAD)) return false;
+  if (memcmp(s_echo + 2, &hdr, sizeof(hdr)) != 0 || memcmp(s_echo + 6, payload, n) != 0) return false;
+  s_echoLen = 0;
+  return true;
+}
+#else
+// No TX-complete hook here: the frame goes into the core buffer and we derive the
+// end of transmission from the byte count (10 bits per byte at 115200 baud).
+static const uint16_t UART_BYTE_US = 87;
+
+bool uartTxSend(const uint8_t* frame, uint8_t len) {
+  if (uartTxBusy()) return false;
+  if (XIAOMI_PORT.availableForWrite() < len) return false;
+  XIAOMI_PORT.write(frame, len);
+  s_txDoneUs = micros() + (uint32_t)len * UART_BYTE_US;
+  s_txBusy = true;
+  return true;
+}
+
+bool uartTxBusy() {
+  if (s_txBusy && (int32_t)(micros() - s_txDoneUs) >= 0) s_txBusy = false;
+  return s_txBusy;
+}
+
+uint32_t uartTxDoneMicros() { return s_txDoneUs; }
+
+bool uartRxIsEcho(const m365proto::FrameHeader&, const uint8_t*) { return false; }
+#endif
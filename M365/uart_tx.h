@@ -0,0 +1,19 @@
+#pragma once
+#include "defines.h"
+#include "m365proto.h"
+
+// Hand a complete frame to the UART and return at once. On AVR the core TX ring is
+// drained by its UDRE interrupt and RX is switched back on by transmit-complete; on
+// ESP32 the IDF driver is polled for TX done and RX keeps running.
+// Returns false if the previous frame is still on the wire or there is no room.
+bool uartTxSend(const uint8_t* frame, uint8_t len);
+
+// True while a frame is still being shifted out
+bool uartTxBusy();
+
+// micros() timestamp taken when the last frame finished transmitting
+uint32_t uartTxDoneMicros();
+
+// True if a received frame is the echo of the last frame we sent (ESP32 only; AVR
+// has RX off while transmitting). Each send matches at most one echo.
+bool uartRxIsEcho(const m365proto::FrameHeader& hdr, const uint8_t* payload);
@@ -0,0 +1,71 @@
+#include "ui_cache.h"
+
+static_assert(UIF_COUNT <= 32, "one valid bit per field");
+
+static uint32_t s_value[UIF_COUNT];
+static uint32_t s_valid = 0;   // bit per field
+static uint8_t s_screen = 0;
+static bool s_lost = true;
+
+bool uiScreenEnter(uint8_t id, bool force, uint32_t keep) {
+  if (id == s_screen && !force && !s_lost) return false;
+  s_screen = id;
+  s_lost = false;
+  s_valid &= keep;
+  return true;
+}
+
+uint8_t uiScreenCurrent() { return s_screen; }
+
+void uiCacheInvalidate() {
+  s_lost = true;
+  s_valid = 0;
+}
+
+bool uiFieldDirty(uint8_t field, uint32_t value) {
+  uint32_t bit = 1UL << field;
+  if ((s_valid & bit) && s_value[field] == value) return false;
+  s_value[field] = value;
+  s_valid |= bit;
+  return true;
+}
+
+bool uiFieldDrawn(uint8_t field, uint32_t* value) {
+  if (!(s_valid & (1UL << field))) return false;
+  *value = s_value[field];
+  return true;
+}
+
+uint32_t uiHash(const void* data, uint8_t len) {
+  // FNV-1a
+  const uint8_t* p = (const uint8_t*)data;
+  uint32_t h = 2166136261UL;
+  while (len--) { h ^= *p++; h *= 16777619UL; }
+  return h;
+}
+
+bool uiFieldDirtyBuf(uint8_t field, const void* data, uint8_t len) {
+  return uiFieldDirty(field, uiHash(data, len));
+}
+
+void uiFieldInvalidate(uint8_t field) {
+  s_valid &= ~(1UL << field);
+}
+
+static bool inBoxes(const UiBox* b, uint8_t n, uint8_t col, uint8_t page) {
+  for (uint8_t i = 0; i < n; i++)
+    if (col >= b[i].col0 && col <= b[i].col1 && page >= b[i].page0 && page <= b[i].page1) return true;
+  return false;
+}
+
+void uiClearRegions(const UiLayout& from, const UiLayout& to) {
+  for (uint8_t page = 0; page < 8; page++) {
+    uint8_t col = 0;
+    while (col < 128) {
+      if (!inBoxes(from.use, from.nUse, col, page) || inBoxes(to.paint, to.nPaint, col, page)) { col++; continue; }
+      uint8_t start = col;
+      while (col < 128 && inBoxes(from.use, from.nUse, col, page) && !inBoxes(to.paint, to.nPaint, col, page)) col++;
+      display.clear(start, col - 1, page, page);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "defines.h"
+
+// Dirty-field cache for the display. Each field remembers the value (and format
+// flags folded into it) it was last drawn with; a field is only re-sent to the OLED
+// when that changes. The cache belongs to the current screen: entering another
+// screen, or anything that blanks the panel, starts it over.
+
+enum UiField : uint8_t {
+  // Main screen
+  UIF_SPEED, UIF_TEMP, UIF_TRIP, UIF_TIME, UIF_LOAD,
+  // Big screen
+  UIF_BIG,
+  // Bottom row (main and big screens)
+  UIF_BATT, UIF_RANGE,
+  // Odometer screen
+  UIF_ODO_DIST, UIF_ODO_TIME,
+  // Trip stats screen
+  UIF_TRIP_AVG, UIF_TRIP_MAX, UIF_TRIP_UMIN, UIF_TRIP_UMAX,
+  // Temperatures screen
+  UIF_TEMP_BATT, UIF_TEMP_DRV, UIF_TEMP_AMB,
+  // Battery info screen (5 cell rows)
+  UIF_BI_SUMMARY, UIF_BI_TEMPS, UIF_BI_CELLS, UIF_BI_CELLS_END = UIF_BI_CELLS + 4,
+  // Device info screen
+  UIF_DEVINFO, UIF_FRAME, UIF_I2C,
+  // Load graph screen
+  UIF_GRAPH,
+  UIF_COUNT
+};
+
+// Switch to screen ID; true (and cache emptied, except the keep fields) if the screen
+// changed, force is set or the panel was blanked since. Used by displayClear().
+bool uiScreenEnter(uint8_t id, bool force, uint32_t keep = 0);
+// ID of the screen last entered
+uint8_t uiScreenCurrent();
+
+// The panel content is gone (re-init, direct clear): next screen entry redraws all
+void uiCacheInvalidate();
+
+// True if field must be drawn with value; records value as drawn
+bool uiFieldDirty(uint8_t field, uint32_t value);
+
+// Value field was last drawn with; false if it has not been drawn on this screen
+bool uiFieldDrawn(uint8_t field, uint32_t* value);
+
+// Same for values wider than 32 bits (hashed)
+bool uiFieldDirtyBuf(uint8_t field, const void* data, uint8_t len);
+// The hash used for that (FNV-1a), for callers that keep their own keys
+uint32_t uiHash(const void* data, uint8_t len);
+
+// Force a redraw of field (e.g. something else was drawn over it)
+void uiFieldInvalidate(uint8_t field);
+
+// Screen layout for switching without a full clear. Boxes are in panel columns and
+// pages, both inclusive.
+//   use:   everything the screen may have drawn into
+//   paint: what it overwrites completely (glyph cells included) on the frame it is
+//          entered, whatever the settings
+//   keep:  fields (bit per UiField) it shows the same way and in the same place as
+//          other screens keeping them; left on the panel and in the cache
+struct UiBox { uint8_t col0, col1, page0, page1; };
+struct UiLayout {
+  static const uint8_t MAX_BOXES = 8;
+  UiBox use[MAX_BOXES], paint[MAX_BOXES];
+  uint8_t nUse = 0, nPaint = 0;
+  uint32_t keep = 0;
+
+  UiLayout& uses(uint8_t c0, uint8_t c1, uint8_t p0, uint8_t p1) {
+    if (nUse < MAX_BOXES) use[nUse++] = {c0, c1, p0, p1};
+    return *this;
+  }
+  UiLayout& paints(uint8_t c0, uint8_t c1, uint8_t p0, uint8_t p1) {
+    if (nPaint < MAX_BOXES) paint[nPaint++] = {c0, c1, p0, p1};
+    return *this;
+  }
+};
+
+// Clear what from used and to does not paint, one run per page
+void uiClearRegions(const UiLayout& from, const UiLayout& to);
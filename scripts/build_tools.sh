@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Build the host-side tools (Linux/macOS) into build-local/tools/
+# - m365cap2csv: bus capture -> CSV, using the firmware's protocol decoder (M365/m365proto.h)
+# - m365proto_check: encoder/decoder check on recorded frames; run after the build
+#
+# Usage:
+#   scripts/build_tools.sh
+#   CXX=clang++ scripts/build_tools.sh
+
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT="$(cd "${HERE}/.." && pwd)"
+OUT="${ROOT}/build-local/tools"
+CXX=${CXX:-c++}
+
+mkdir -p "${OUT}"
+echo "[+] m365cap2csv"
+"${CXX}" -O2 -std=c++11 -Wall -Wextra -I"${ROOT}/M365" -o "${OUT}/m365cap2csv" "${ROOT}/tools/m365cap2csv.cpp"
+echo "[+] m365proto_check"
+"${CXX}" -O2 -std=c++11 -Wall -Wextra -I"${ROOT}/M365" -o "${OUT}/m365proto_check" "${ROOT}/tools/m365proto_check.cpp"
+"${OUT}/m365proto_check"
+echo "[+] Tools in ${OUT}"
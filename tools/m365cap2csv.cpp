@@ -0,0 +1,167 @@
+// m365cap2csv: turn a raw M365 bus capture into CSV using the firmware's own decoder
+// (M365/m365proto.h).
+//
+// Build:  scripts/build_tools.sh   (or: c++ -O2 -std=c++11 -IM365 -o m365cap2csv tools/m365cap2csv.cpp)
+// Usage:  m365cap2csv [--raw] [capture.bin|-] > out.csv
+//
+// The capture is the byte stream as seen on the bus (e.g. a logic analyser or a USB
+// UART dump at 115200 8N1). Default output has one row per known telemetry field:
+//   frame,addr,cmd,field,value
+// --raw prints every valid frame instead:
+//   frame,addr,hz,cmd,len,payload
+// Totals and throughput go to stderr.
+#include "m365proto.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+using namespace m365proto;
+
+namespace {
+
+enum FieldType : uint8_t { F_U8, F_U16, F_I16, F_U32 };
+struct Field { uint8_t addr, cmd, offset; FieldType type; const char* name; };
+
+#define FIELD(addr, cmd, T, member, type) { addr, cmd, (uint8_t)offsetof(T, member), type, #member }
+const Field kFields[] = {
+  FIELD(ADDR_BLE_ESC, 0x00, A20C00HZ65, throttle, F_U8),
+  FIELD(ADDR_BLE_ESC, 0x00, A20C00HZ65, brake, F_U8),
+  FIELD(ADDR_BMS, 0x31, A25C31, remainCapacity, F_U16),
+  FIELD(ADDR_BMS, 0x31, A25C31, remainPercent, F_U8),
+  FIELD(ADDR_BMS, 0x31, A25C31, current, F_I16),
+  FIELD(ADDR_BMS, 0x31, A25C31, voltage, F_I16),
+  FIELD(ADDR_BMS, 0x31, A25C31, temp1, F_U8),
+  FIELD(ADDR_BMS, 0x31, A25C31, temp2, F_U8),
+  FIELD(ADDR_BMS, 0x40, A25C40, c1, F_I16),  FIELD(ADDR_BMS, 0x40, A25C40, c2, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c3, F_I16),  FIELD(ADDR_BMS, 0x40, A25C40, c4, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c5, F_I16),  FIELD(ADDR_BMS, 0x40, A25C40, c6, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c7, F_I16),  FIELD(ADDR_BMS, 0x40, A25C40, c8, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c9, F_I16),  FIELD(ADDR_BMS, 0x40, A25C40, c10, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c11, F_I16), FIELD(ADDR_BMS, 0x40, A25C40, c12, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c13, F_I16), FIELD(ADDR_BMS, 0x40, A25C40, c14, F_I16),
+  FIELD(ADDR_BMS, 0x40, A25C40, c15, F_I16),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, speed, F_I16),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, averageSpeed, F_U16),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, mileageTotal, F_U32),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, mileageCurrent, F_U16),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, elapsedPowerOnTime, F_U16),
+  FIELD(ADDR_ESC, 0xB0, A23CB0, mainframeTemp, F_I16),
+  FIELD(ADDR_ESC, 0x3E, A23C3E, i1, F_I16),
+  FIELD(ADDR_ESC, 0x23, A23C23, remainMileage, F_U16),
+  FIELD(ADDR_ESC, 0x3A, A23C3A, powerOnTime, F_U16),
+  FIELD(ADDR_ESC, 0x3A, A23C3A, ridingTime, F_U16),
+};
+#undef FIELD
+
+// Buffered writer; printf is far too slow for millions of rows
+class Out {
+public:
+  explicit Out(FILE* f) : m_f(f), m_n(0) {}
+  ~Out() { flush(); }
+  void flush() { fwrite(m_buf, 1, m_n, m_f); m_n = 0; }
+  void reserve(size_t n) { if (m_n + n > sizeof(m_buf)) flush(); }
+  void ch(char c) { m_buf[m_n++] = c; }
+  void str(const char* s) { while (*s) m_buf[m_n++] = *s++; }
+  void u(uint64_t v) {
+    char t[20]; int i = 0;
+    do { t[i++] = (char)('0' + v % 10); v /= 10; } while (v);
+    while (i) m_buf[m_n++] = t[--i];
+  }
+  void i(int64_t v) { if (v < 0) { ch('-'); u((uint64_t)(-v)); } else u((uint64_t)v); }
+  void hex(uint8_t v) {
+    static const char d[] = "0123456789abcdef";
+    m_buf[m_n++] = d[v >> 4]; m_buf[m_n++] = d[v & 15];
+  }
+private:
+  FILE* m_f;
+  size_t m_n;
+  char m_buf[1 << 16];
+};
+
+uint32_t readLe(const uint8_t* p, FieldType t) {
+  switch (t) {
+    case F_U8: return p[0];
+    case F_U16: case F_I16: return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+    default: return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+}
+
+void emitRaw(Out& out, uint64_t frame, const FrameHeader& h, const uint8_t* p, uint8_t n) {
+  out.reserve(64 + 2 * n);
+  out.u(frame); out.ch(',');
+  out.hex(h.addr); out.ch(','); out.hex(h.hz); out.ch(','); out.hex(h.cmd); out.ch(',');
+  out.u(n); out.ch(',');
+  for (uint8_t k = 0; k < n; k++) out.hex(p[k]);
+  out.ch('\n');
+}
+
+// Frames whose payload does not match the layout size are not decoded; addr 0x20
+// cmd 0x00 frames other than hz 0x65 are left to --raw
+void emitFields(Out& out, uint64_t frame, const FrameHeader& h, const uint8_t* p, uint8_t n) {
+  uint8_t size = layoutSize(h);
+  if (size == 0 || n != size) return;
+  for (size_t k = 0; k < sizeof(kFields) / sizeof(kFields[0]); k++) {
+    const Field& f = kFields[k];
+    if (f.addr != h.addr || f.cmd != h.cmd) continue;
+    out.reserve(64);
+    out.u(frame); out.ch(',');
+    out.hex(h.addr); out.ch(','); out.hex(h.cmd); out.ch(',');
+    out.str(f.name); out.ch(',');
+    uint32_t v = readLe(p + f.offset, f.type);
+    if (f.type == F_I16) out.i((int16_t)v); else out.u(v);
+    out.ch('\n');
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  bool raw = false;
+  const char* path = "-";
+  for (int a = 1; a < argc; a++) {
+    if (!strcmp(argv[a], "--raw")) raw = true;
+    else if (!strcmp(argv[a], "-h") || !strcmp(argv[a], "--help")) {
+      fprintf(stderr, "usage: %s [--raw] [capture.bin|-]\n", argv[0]);
+      return 0;
+    } else path = argv[a];
+  }
+
+  FILE* in = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+  if (!in) { perror(path); return 1; }
+
+  Out out(stdout);
+  out.str(raw ? "frame,addr,hz,cmd,len,payload\n" : "frame,addr,cmd,field,value\n");
+
+  Decoder<255> rx;
+  static uint8_t chunk[1 << 20];
+  uint64_t bytes = 0, frames = 0, badCs = 0, oversize = 0;
+  clock_t t0 = clock();
+  size_t got;
+  while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+    bytes += got;
+    for (size_t k = 0; k < got; k++) {
+      switch (rx.push(chunk[k])) {
+        case RX_FRAME:
+          if (raw) emitRaw(out, frames, rx.header(), rx.payload(), rx.payloadLen());
+          else emitFields(out, frames, rx.header(), rx.payload(), rx.payloadLen());
+          frames++;
+          break;
+        case RX_BAD_CHECKSUM: badCs++; break;
+        case RX_OVERSIZE: oversize++; break;
+        default: break;
+      }
+    }
+  }
+  out.flush();
+  if (in != stdin) fclose(in);
+
+  double s = (double)(clock() - t0) / CLOCKS_PER_SEC;
+  fprintf(stderr, "%llu bytes, %llu frames, %llu checksum errors, %llu bad lengths",
+          (unsigned long long)bytes, (unsigned long long)frames,
+          (unsigned long long)badCs, (unsigned long long)oversize);
+  if (s > 0) fprintf(stderr, " in %.3f s (%.2f Mframes/s)", s, frames / s / 1e6);
+  fputc('\n', stderr);
+  return 0;
+}
@@ -0,0 +1,159 @@
+// m365proto_check: host check of the bus protocol code in M365/m365proto.h. Recorded
+// frames go through the encoder and the streaming decoder, and the telemetry layout
+// lookup is checked, including the hz 0x64/0x65 split of addr 0x20 cmd 0x00.
+//
+// Build:  scripts/build_tools.sh   (builds and runs it)
+//   or:   c++ -O2 -std=c++11 -IM365 -o m365proto_check tools/m365proto_check.cpp
+// Prints one line per failed check and exits non-zero if any failed.
+#include "m365proto.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace m365proto;
+
+namespace {
+
+int g_failed = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, #cond); g_failed++; } } while (0)
+
+// Frames as seen on the bus
+const uint8_t kCtl65[] = { 0x55, 0xAA, 0x07, 0x20, 0x65, 0x00, 0x04, 0x26, 0x2C, 0x00, 0x00, 0x1D, 0xFF };
+const uint8_t kCtl64[] = { 0x55, 0xAA, 0x07, 0x20, 0x64, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x70, 0xFF };
+const uint8_t kSt21[]  = { 0x55, 0xAA, 0x06, 0x21, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x74, 0xFF };
+const uint8_t kBmsQ[]  = { 0x55, 0xAA, 0x03, 0x22, 0x01, 0x31, 0x0A, 0x9E, 0xFF };
+const uint8_t kBms31[] = { 0x55, 0xAA, 0x0C, 0x25, 0x01, 0x31, 0x40, 0x1F, 0x4B, 0x00, 0x38, 0xFF, 0x8C, 0x0F, 0x14, 0x15, 0xF7, 0xFC };
+const uint8_t kEscQ[]  = { 0x55, 0xAA, 0x06, 0x20, 0x61, 0xB0, 0x20, 0x02, 0x26, 0x2C, 0x54, 0xFE };
+const uint8_t kEscW[]  = { 0x55, 0xAA, 0x04, 0x20, 0x03, 0x7C, 0x01, 0x00, 0x5B, 0xFF };
+
+struct Counts { int frames, badCs, oversize; };
+
+// Feed n bytes; the last complete frame is left in rx
+template <uint8_t N>
+Counts feed(Decoder<N>& rx, const uint8_t* p, size_t n) {
+  Counts c = { 0, 0, 0 };
+  for (size_t k = 0; k < n; k++) {
+    switch (rx.push(p[k])) {
+      case RX_FRAME: c.frames++; break;
+      case RX_BAD_CHECKSUM: c.badCs++; break;
+      case RX_OVERSIZE: c.oversize++; break;
+      default: break;
+    }
+  }
+  return c;
+}
+
+void checkEncoder() {
+  uint8_t out[32];
+  uint8_t n = encodeBmsRead(out, 0x31, 0x0A);
+  CHECK(n == sizeof(kBmsQ) && memcmp(out, kBmsQ, n) == 0);
+  n = encodeEscRead(out, 0xB0, 0x20, 0x26, 0x2C);
+  CHECK(n == sizeof(kEscQ) && memcmp(out, kEscQ, n) == 0);
+  n = encodeEscWrite(out, REG_CRUISE, 1);
+  CHECK(n == sizeof(kEscW) && memcmp(out, kEscW, n) == 0);
+  CHECK(checksum(kBms31 + 2, sizeof(kBms31) - 4) == (uint16_t)(kBms31[16] | (kBms31[17] << 8)));
+}
+
+void checkFrames() {
+  Decoder<64> rx;
+  Counts c = feed(rx, kBms31, sizeof(kBms31));
+  CHECK(c.frames == 1 && c.badCs == 0 && c.oversize == 0 && !rx.busy());
+  CHECK(rx.header().addr == ADDR_BMS && rx.header().hz == OP_READ && rx.header().cmd == 0x31);
+  A25C31 b = A25C31();
+  CHECK(rx.payloadAs(b));
+  CHECK(b.remainCapacity == 8000 && b.remainPercent == 75 && b.current == -200 && b.voltage == 3980);
+  CHECK(b.temp1 == 0x14 && b.temp2 == 0x15);
+  A23C3A wrong = A23C3A();
+  CHECK(!rx.payloadAs(wrong));
+
+  // Our own requests decode back to what was encoded
+  uint8_t out[32];
+  uint8_t n = encodeEscWrite(out, REG_KERS, -2);
+  c = feed(rx, out, n);
+  CHECK(c.frames == 1 && rx.header().addr == ADDR_BLE_ESC && rx.header().hz == OP_WRITE);
+  CHECK(rx.header().cmd == REG_KERS && rx.payloadLen() == 2 && rx.payload()[0] == 0xFE && rx.payload()[1] == 0xFF);
+}
+
+// Addr 0x20 cmd 0x00 carries throttle/brake only with hz 0x65; a 0x64 frame of the
+// same size must not be taken for it
+void checkHzSplit() {
+  Decoder<64> rx;
+  CHECK(feed(rx, kCtl65, sizeof(kCtl65)).frames == 1);
+  CHECK(rx.header().hz == HZ_CONTROL && layoutSize(rx.header()) == sizeof(A20C00HZ65));
+  A20C00HZ65 ctl = A20C00HZ65();
+  CHECK(rx.payloadAs(ctl) && ctl.throttle == 0x26 && ctl.brake == 0x2C);
+
+  CHECK(feed(rx, kCtl64, sizeof(kCtl64)).frames == 1);
+  CHECK(rx.header().hz == HZ_STATUS && rx.payloadLen() == sizeof(A20C00HZ65));
+  CHECK(layoutSize(rx.header()) == 0);
+
+  CHECK(feed(rx, kSt21, sizeof(kSt21)).frames == 1);
+  CHECK(rx.header().addr == ADDR_BLE_BMS && rx.payloadLen() == sizeof(A21C00HZ64));
+
+  // Requests carry no telemetry layout
+  CHECK(feed(rx, kBmsQ, sizeof(kBmsQ)).frames == 1 && layoutSize(rx.header()) == 0);
+  CHECK(feed(rx, kEscQ, sizeof(kEscQ)).frames == 1 && layoutSize(rx.header()) == 0);
+}
+
+void checkErrors() {
+  Decoder<16> rx;
+  uint8_t bad[sizeof(kCtl65)];
+  memcpy(bad, kCtl65, sizeof(bad));
+  bad[8] ^= 0x01;
+  Counts c = feed(rx, bad, sizeof(bad));
+  CHECK(c.frames == 0 && c.badCs == 1 && !rx.busy());
+
+  // Longer than the decoder accepts, then a good frame right behind it
+  const uint8_t big[] = { 0x55, 0xAA, 0x20, 0x23, 0x01, 0xB0 };
+  c = feed(rx, big, sizeof(big));
+  CHECK(c.oversize == 1);
+  c = feed(rx, kCtl65, sizeof(kCtl65));
+  CHECK(c.frames == 1 && c.badCs == 0);
+
+  // A length byte that is 0x55 can be the start of the next frame
+  const uint8_t resync[] = { 0x55, 0xAA, 0x55, 0xAA };
+  c = feed(rx, resync, sizeof(resync));
+  CHECK(c.oversize == 1 && rx.busy());
+  c = feed(rx, kCtl65 + 2, sizeof(kCtl65) - 2);
+  CHECK(c.frames == 1);
+
+  // Truncated frame: reset() drops it as the firmware does on an inter-byte timeout
+  feed(rx, kBmsQ, 5);
+  CHECK(rx.busy());
+  rx.reset();
+  CHECK(!rx.busy() && feed(rx, kBmsQ, sizeof(kBmsQ)).frames == 1);
+}
+
+// All frames back to back with line noise in between, split at every offset
+void checkStream() {
+  const uint8_t* frames[] = { kCtl65, kBmsQ, kBms31, kCtl64, kSt21, kEscQ, kEscW };
+  const size_t sizes[] = { sizeof(kCtl65), sizeof(kBmsQ), sizeof(kBms31), sizeof(kCtl64), sizeof(kSt21), sizeof(kEscQ), sizeof(kEscW) };
+  const uint8_t noise[] = { 0x00, 0x55, 0xFF, 0xAA };
+  const int count = (int)(sizeof(frames) / sizeof(frames[0]));
+  uint8_t buf[256];
+  size_t n = 0;
+  for (int k = 0; k < count; k++) {
+    memcpy(buf + n, noise, sizeof(noise)); n += sizeof(noise);
+    memcpy(buf + n, frames[k], sizes[k]); n += sizes[k];
+  }
+  for (size_t split = 0; split <= n; split++) {
+    Decoder<64> rx;
+    Counts a = feed(rx, buf, split);
+    Counts b = feed(rx, buf + split, n - split);
+    CHECK(a.frames + b.frames == count && a.badCs + b.badCs == 0);
+  }
+}
+
+} // namespace
+
+int main() {
+  checkEncoder();
+  checkFrames();
+  checkHzSplit();
+  checkErrors();
+  checkStream();
+  if (g_failed) { fprintf(stderr, "m365proto_check: %d failed\n", g_failed); return 1; }
+  printf("m365proto_check: ok\n");
+  return 0;
+}